@@ -1,3 +1,4 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -5,16 +6,106 @@
 #include <sys/ipc.h>
 #include <sys/shm.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
 #include <time.h>
 #include <sys/wait.h> 
 #include <signal.h>
+#include <pthread.h>
+#include <getopt.h>
+#include <errno.h>
+#include <sys/mman.h>
 
 
 #define BOARD_SIZE 10
 #define NUM_PLAYERS_MIN 2
-#define NUM_PLAYERS_MAX 10
+#define NUM_PLAYERS_MAX 4096
 #define NUM_SHIPS 5
 #define SHIP_SIZES {2,2,3,3,4}
+#define BOARD_CELLS (BOARD_SIZE * BOARD_SIZE)
+#define BITBOARD_WORDS ((BOARD_CELLS + 63) / 64)
+#define CELL(x, y) ((x) * BOARD_SIZE + (y))
+#define BENCH_GAMES 1000000
+#define BENCH_FLEETS 64
+#define TOURNAMENT_DEFAULT_PLAYERS 4
+#define MAX_STRATEGIES 16
+// Events the log can hold before players wait for the writer; a power of two
+#define LOG_CAPACITY 65536
+#define LOG_MAGIC "BSHIPLOG"
+// A game lasts at most one round per cell plus the final elimination round
+#define MAX_ROUNDS (BOARD_CELLS + 1)
+#define CACHE_LINE 64
+#define HUGE_PAGE_SIZE (2UL << 20)
+
+// Per-process random number generator (xorshift64*). Tournament games seed
+// it from (seed, game number) so results don't depend on the worker count.
+typedef uint64_t GameRng;
+
+static inline uint64_t splitmix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+static inline int random_below(GameRng *rng, int limit) {
+    *rng ^= *rng >> 12;
+    *rng ^= *rng << 25;
+    *rng ^= *rng >> 27;
+    return (int)(((*rng * 0x2545f4914f6cdd1dULL) >> 32) % (uint64_t)limit);
+}
+
+// Bitboard with one bit per cell. A 10x10 board fits in a 128-bit mask; larger
+// boards use more words and the word loops get vectorized by the compiler.
+typedef struct {
+    uint64_t words[BITBOARD_WORDS];
+} Bitboard;
+
+static inline void bitboard_set(Bitboard *board, int cell) {
+    board->words[cell / 64] |= (uint64_t)1 << (cell % 64);
+}
+
+static inline bool bitboard_test(const Bitboard *board, int cell) {
+    return (board->words[cell / 64] >> (cell % 64)) & 1;
+}
+
+// Atomically sets a cell; true only for the caller that actually set it, so
+// concurrent attackers never both resolve the same cell on the same board
+static inline bool bitboard_claim(Bitboard *board, int cell) {
+    uint64_t bit = (uint64_t)1 << (cell % 64);
+    return !(__atomic_fetch_or(&board->words[cell / 64], bit, __ATOMIC_RELAXED) & bit);
+}
+
+static inline void bitboard_or(Bitboard *dst, const Bitboard *src) {
+    for (int i = 0; i < BITBOARD_WORDS; i++) {
+        dst->words[i] |= src->words[i];
+    }
+}
+
+static inline bool bitboard_intersects(const Bitboard *a, const Bitboard *b) {
+    uint64_t any = 0;
+    for (int i = 0; i < BITBOARD_WORDS; i++) {
+        any |= a->words[i] & b->words[i];
+    }
+    return any != 0;
+}
+
+// True if every cell set in a is also set in b
+static inline bool bitboard_subset(const Bitboard *a, const Bitboard *b) {
+    uint64_t outside = 0;
+    for (int i = 0; i < BITBOARD_WORDS; i++) {
+        outside |= a->words[i] & ~b->words[i];
+    }
+    return outside == 0;
+}
+
+static inline int bitboard_popcount(const Bitboard *board) {
+    int count = 0;
+    for (int i = 0; i < BITBOARD_WORDS; i++) {
+        count += __builtin_popcountll(board->words[i]);
+    }
+    return count;
+}
 
 // Structure for a ship
 typedef struct {
@@ -22,121 +113,904 @@ typedef struct {
     int hits;
     bool vertical;
     int components[4][2];
+    Bitboard mask;
 } Ship;
 
-// Structure for a player
+// A player's ships and the cells they cover. Attackers update the hit
+// counters, so each fleet starts on its own cache line.
+typedef struct {
+    _Alignas(CACHE_LINE) Ship ships[NUM_SHIPS];
+    Bitboard occupied;
+} Fleet;
+
+// Bitboard padded to whole cache lines, so concurrent writers to the boards
+// of neighbouring players don't invalidate each other's lines
+typedef struct {
+    _Alignas(CACHE_LINE) Bitboard board;
+} PaddedBitboard;
+
+// Cells a player hasn't fired at yet. Drawing a random index and moving the
+// last cell into its place is an incremental Fisher-Yates shuffle, so a pick
+// costs the same on an empty board as on an almost full one. position[]
+// locates each cell in the list (-1 once it leaves) so specific cells can be
+// taken out too. Under the hunt strategy the cells next to a hit move from
+// the list to the hunt stack, which is emptied before drawing at random again.
+typedef struct {
+    _Alignas(CACHE_LINE) int count;
+    int hunt_count;
+    int cells[BOARD_CELLS];
+    int position[BOARD_CELLS];
+    int hunt[BOARD_CELLS];
+} TargetList;
+
+// How a player chooses where to fire
+typedef enum {
+    STRATEGY_RANDOM,
+    STRATEGY_HUNT
+} AttackStrategy;
+
+static const char *const strategy_names[] = {"random", "hunt"};
+
+// Turn latency counters, written only by the owning player
+typedef struct {
+    _Alignas(CACHE_LINE) long turns;
+    long turn_nanoseconds;
+    long max_turn_nanoseconds;
+} PlayerStats;
+
+// Outcome of resolving one attack against one player
+typedef enum {
+    ATTACK_MISS,
+    ATTACK_HIT,
+    ATTACK_SUNK
+} AttackResult;
+
+// Process-shared round barrier. Unlike pthread_barrier_t, eliminated players
+// can leave it, so the remaining ones never wait for processes that are gone.
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int parties;
+    int waiting;
+    unsigned generation;
+} RoundBarrier;
+
+// What happened in the game. Players and the manager append events to the
+// shared log and a separate writer process renders them, so no game process
+// ever blocks on the terminal.
+typedef enum {
+    EVENT_FLEET,      // A player placed its fleet
+    EVENT_ATTACK,     // A player fired at (x, y)
+    EVENT_HIT,        // One of the player's ships was hit
+    EVENT_SUNK,       // One of the player's ships was sunk, ships_left remain
+    EVENT_ELIMINATED, // The player lost its whole fleet
+    EVENT_GAME_OVER   // player is the winner's pid, or -1 if there is none
+} EventType;
+
+// Fixed-size binary record, the same in shared memory and in log files
+typedef struct {
+    uint16_t type;
+    uint16_t x, y;
+    uint16_t ships_left;
+    int32_t player;
+    uint32_t round;
+    uint16_t fleet[NUM_SHIPS][3]; // EVENT_FLEET: x, y and vertical of each ship
+} GameEvent;
+
+// Slot of the event ring. sequence says whose turn it is: the producer that
+// reserved position p may write when it equals p, and the writer may read
+// once it equals p + 1.
+typedef struct {
+    uint64_t sequence;
+    GameEvent event;
+} LogSlot;
+
+// Bounded multi-producer, single-consumer ring of events. head and tail are
+// on separate cache lines since players bump one and the writer the other.
+// The writer holds writer_lock (a robust mutex) for as long as it runs, so a
+// producer waiting on a full ring can tell when it died.
 typedef struct {
-    pid_t player_pid;
-    Ship ships[NUM_SHIPS];
-    bool is_alive;
-    bool attacked_positions[BOARD_SIZE][BOARD_SIZE];
-    bool attacked_ships[BOARD_SIZE][BOARD_SIZE];
-} Player;
-
-// Structure for shared memory
+    _Alignas(CACHE_LINE) uint64_t head;
+    _Alignas(CACHE_LINE) uint64_t tail;
+    bool closed;
+    bool writer_gone; // Set once a producer sees the writer died
+    pthread_mutex_t writer_lock;
+    LogSlot *slots;
+} EventLog;
+
+// Start of a binary log file, followed by the events
+typedef struct {
+    char magic[8];
+    uint32_t board_size;
+    uint32_t num_ships;
+    uint32_t event_size;
+    uint32_t reserved;
+} LogFileHeader;
+
+// Header of the game's memory segment. The per-player state follows it in
+// the same mapping as one array per field (structure of arrays), sized for
+// the actual number of players. The segment is mapped before forking, so the
+// pointers are valid in every player process.
 typedef struct {
-    bool is_attacked[BOARD_SIZE][BOARD_SIZE];
-    Player players[NUM_PLAYERS_MAX];
+    int num_players;
     int remaining_players;
+    bool game_over;
+    bool log_events; // Off in headless games
+    unsigned round;
+    RoundBarrier barrier;
+    EventLog log;
+    size_t mapping_size;
+    pid_t *player_pids;
+    bool *is_alive;
+    Fleet *fleets;
+    AttackStrategy *strategies;
+    TargetList *targets;                // Cells each player hasn't fired at
+    PaddedBitboard *attacked_ships;     // Cells of each player's ships already hit
+    PlayerStats *stats;
+    // Alive players with a ship on each cell: cell_players[cell_start[c]] up
+    // to cell_count[c] entries. An attack only visits the players listed for
+    // its cell instead of every player in the game.
+    int cell_start[BOARD_CELLS];
+    int cell_count[BOARD_CELLS];
+    int *cell_players;
 } SharedData;
 
-void attack_player(SharedData *shared_data, int attacker_index, int attack_x, int attack_y);
-void print_ship_positions(Player *player);
-bool check_overlap(Player *player, int ship_size, int x, int y, bool vertical);
+// Aggregated results of the games played by one tournament worker
+typedef struct {
+    long games;
+    long draws;
+    long total_rounds;
+    long rounds_histogram[MAX_ROUNDS + 1];
+    long wins[NUM_PLAYERS_MAX];
+    long winner_ships_alive[NUM_SHIPS];
+    long ships_sunk;
+} TournamentStats;
 
-void game_manager(SharedData *shared_data, int num_players) {
-    int winner_pid = -1;
-    while (shared_data->remaining_players > 1) {
-        for (int i = 0; i < num_players; i++) {
-            Player *current_player = &shared_data->players[i];
+SharedData *shared_data_create(int num_players, bool shared);
+void shared_data_destroy(SharedData *shared_data);
+void build_cell_index(SharedData *shared_data);
+void assign_strategies(SharedData *shared_data, const AttackStrategy *strategies, int num_strategies);
+int parse_strategies(const char *spec, AttackStrategy *strategies);
+AttackResult attack_player(SharedData *shared_data, int target_index, int attack_x, int attack_y);
+AttackResult resolve_attack(Fleet *fleet, int attack_x, int attack_y);
+int count_remaining_ships(const Fleet *fleet);
+void place_ships(Fleet *fleet, GameRng *rng);
+void log_event(SharedData *shared_data, GameEvent event);
+bool event_log_pop(EventLog *log, GameEvent *event);
+void render_event(FILE *out, const GameEvent *event);
+int event_log_init(EventLog *log);
+void log_writer_process(EventLog *log, FILE *binary_log);
+int replay_log(const char *path);
+bool check_overlap(const Fleet *fleet, int ship_size, int x, int y, bool vertical);
+Bitboard ship_mask(int ship_size, int x, int y, bool vertical);
+void run_benchmark(void);
+void take_turn(SharedData *shared_data, int player_index, GameRng *rng);
+bool eliminate_players(SharedData *shared_data);
+int play_headless_game(SharedData *game, GameRng *rng, int *rounds);
+void run_tournament(long num_games, int num_players, int num_workers, uint64_t seed,
+                    const AttackStrategy *strategies, int num_strategies);
+void player_process(SharedData *shared_data, int player_index);
+int barrier_init(RoundBarrier *barrier, int parties);
+void barrier_wait(RoundBarrier *barrier);
+void barrier_leave(RoundBarrier *barrier);
 
-            if (!current_player->is_alive) {
-                continue; // Skip eliminated players
-            }
+static long elapsed_nanoseconds(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000000000L + (now.tv_nsec - start->tv_nsec);
+}
+
+static size_t align_up(size_t size, size_t alignment) {
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+static int fleet_cells(void) {
+    int ship_sizes[NUM_SHIPS] = SHIP_SIZES;
+    int cells = 0;
+    for (int k = 0; k < NUM_SHIPS; k++) {
+        cells += ship_sizes[k];
+    }
+    return cells;
+}
+
+// Maps a zeroed segment for the game. Shared segments live in a memfd so the
+// forked players see the same pages; they use explicit huge pages when the
+// segment spans at least one and the system has them reserved, otherwise the
+// kernel is asked for transparent huge pages. Tournament workers play in a
+// private mapping with the same layout. Returns NULL on failure.
+SharedData *shared_data_create(int num_players, bool shared) {
+    size_t offset = align_up(sizeof(SharedData), CACHE_LINE);
+    size_t pids_offset = offset;
+    offset = align_up(offset + num_players * sizeof(pid_t), CACHE_LINE);
+    size_t alive_offset = offset;
+    offset = align_up(offset + num_players * sizeof(bool), CACHE_LINE);
+    size_t strategies_offset = offset;
+    offset = align_up(offset + num_players * sizeof(AttackStrategy), CACHE_LINE);
+    size_t fleets_offset = offset;
+    offset += num_players * sizeof(Fleet);
+    size_t targets_offset = offset;
+    offset += num_players * sizeof(TargetList);
+    size_t ships_offset = offset;
+    offset += num_players * sizeof(PaddedBitboard);
+    size_t stats_offset = offset;
+    offset += num_players * sizeof(PlayerStats);
+    size_t cells_offset = offset;
+    offset = align_up(offset + (size_t)num_players * fleet_cells() * sizeof(int), CACHE_LINE);
+    size_t log_offset = offset;
+    if (shared) {
+        offset += LOG_CAPACITY * sizeof(LogSlot); // Headless games don't log
+    }
 
-            // Check if the player has lost all ships
-            bool has_lost_all_ships = true;
-            for (int j = 0; j < NUM_SHIPS; j++) {
-                if (current_player->ships[j].size != 0) {
-                    has_lost_all_ships = false;
-                    break;
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    size_t size = align_up(offset, page_size);
+    void *mapping = MAP_FAILED;
+    if (shared) {
+        int fd = -1;
+        if (size >= HUGE_PAGE_SIZE) {
+            fd = memfd_create("battleship", MFD_CLOEXEC | MFD_HUGETLB);
+            if (fd != -1) {
+                size_t huge_size = align_up(size, HUGE_PAGE_SIZE);
+                if (ftruncate(fd, huge_size) == 0) {
+                    mapping = mmap(NULL, huge_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                }
+                if (mapping != MAP_FAILED) {
+                    size = huge_size;
                 }
+                close(fd);
             }
+        }
+        if (mapping == MAP_FAILED) {
+            fd = memfd_create("battleship", MFD_CLOEXEC);
+            if (fd == -1) {
+                return NULL;
+            }
+            if (ftruncate(fd, size) == 0) {
+                mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            }
+            close(fd);
+        }
+    } else {
+        mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
+    if (mapping == MAP_FAILED) {
+        return NULL;
+    }
+    if (size >= HUGE_PAGE_SIZE) {
+        madvise(mapping, size, MADV_HUGEPAGE); // Only a hint, failure is harmless
+    }
+
+    char *base = mapping;
+    SharedData *shared_data = mapping;
+    shared_data->num_players = num_players;
+    shared_data->mapping_size = size;
+    shared_data->player_pids = (pid_t *)(base + pids_offset);
+    shared_data->is_alive = (bool *)(base + alive_offset);
+    shared_data->fleets = (Fleet *)(base + fleets_offset);
+    shared_data->strategies = (AttackStrategy *)(base + strategies_offset);
+    shared_data->targets = (TargetList *)(base + targets_offset);
+    shared_data->attacked_ships = (PaddedBitboard *)(base + ships_offset);
+    shared_data->stats = (PlayerStats *)(base + stats_offset);
+    shared_data->cell_players = (int *)(base + cells_offset);
+    if (shared) {
+        shared_data->log.slots = (LogSlot *)(base + log_offset);
+        for (uint64_t i = 0; i < LOG_CAPACITY; i++) {
+            shared_data->log.slots[i].sequence = i;
+        }
+    }
+    return shared_data;
+}
+
+void shared_data_destroy(SharedData *shared_data) {
+    if (munmap(shared_data, shared_data->mapping_size) == -1) {
+        perror("Failed to unmap shared memory segment");
+    }
+}
+
+// Player i plays strategies[i % num_strategies]
+void assign_strategies(SharedData *shared_data, const AttackStrategy *strategies, int num_strategies) {
+    for (int i = 0; i < shared_data->num_players; i++) {
+        shared_data->strategies[i] = strategies[i % num_strategies];
+    }
+}
 
-            if (has_lost_all_ships) {
-                printf("\033[0;31mPlayer %d has lost all ships and is eliminated!\033[0m\n", current_player->player_pid);
-                current_player->is_alive = false;
-                shared_data->remaining_players--;
-                kill(current_player->player_pid, SIGKILL); // Terminate the loser's process
-                continue; // Move to the next player
+// Parses a comma-separated list of strategy names. Returns how many were
+// read, or 0 if the list is invalid.
+int parse_strategies(const char *spec, AttackStrategy *strategies) {
+    int count = 0;
+    while (true) {
+        size_t length = strcspn(spec, ",");
+        int found = -1;
+        for (int k = 0; k < (int)(sizeof(strategy_names) / sizeof(strategy_names[0])); k++) {
+            if (strlen(strategy_names[k]) == length && strncmp(spec, strategy_names[k], length) == 0) {
+                found = k;
             }
+        }
+        if (found < 0 || count == MAX_STRATEGIES) {
+            return 0;
+        }
+        strategies[count++] = (AttackStrategy)found;
+        if (spec[length] == '\0') {
+            return count;
+        }
+        spec += length + 1;
+    }
+}
 
-            int attack_x, attack_y;
-            do {
-                attack_x = rand() % BOARD_SIZE;
-                attack_y = rand() % BOARD_SIZE;
-            } while (current_player->attacked_positions[attack_x][attack_y]);
-            printf("Player %d is attacking position (%d, %d)\n", current_player->player_pid, attack_x, attack_y);
-            current_player->attacked_positions[attack_x][attack_y] = true;
-
-            for (int j = 0; j < num_players; j++) {
-                if (j != i && shared_data->players[j].is_alive) {
-                    if (!shared_data->players[j].attacked_ships[attack_x][attack_y]) {
-                        attack_player(shared_data, j, attack_x, attack_y);
-                        shared_data->players[j].attacked_ships[attack_x][attack_y] = true;
-                    }
-                }
+static void target_list_reset(TargetList *targets) {
+    targets->count = BOARD_CELLS;
+    targets->hunt_count = 0;
+    for (int cell = 0; cell < BOARD_CELLS; cell++) {
+        targets->cells[cell] = cell;
+        targets->position[cell] = cell;
+    }
+}
+
+static void target_list_remove(TargetList *targets, int cell) {
+    int index = targets->position[cell];
+    int last = targets->cells[--targets->count];
+    targets->cells[index] = last;
+    targets->position[last] = index;
+    targets->position[cell] = -1;
+}
+
+// Next cell to fire at: the most recent hunt candidate if there is one,
+// otherwise a uniformly random cell that hasn't been fired at
+static int target_list_next(TargetList *targets, GameRng *rng) {
+    if (targets->hunt_count > 0) {
+        return targets->hunt[--targets->hunt_count];
+    }
+    int cell = targets->cells[random_below(rng, targets->count)];
+    target_list_remove(targets, cell);
+    return cell;
+}
+
+// After a hit, queues the neighbours of the cell that are still untouched
+static void target_list_hunt_around(TargetList *targets, int x, int y) {
+    static const int offsets[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+    for (int k = 0; k < 4; k++) {
+        int nx = x + offsets[k][0], ny = y + offsets[k][1];
+        if (nx < 0 || nx >= BOARD_SIZE || ny < 0 || ny >= BOARD_SIZE) continue;
+        int cell = CELL(nx, ny);
+        if (targets->position[cell] >= 0) {
+            target_list_remove(targets, cell);
+            targets->hunt[targets->hunt_count++] = cell;
+        }
+    }
+}
+
+// Counting sort of the alive players by the cells their ships cover. Called
+// once the fleets are placed; players stay in index order within each cell.
+void build_cell_index(SharedData *shared_data) {
+    int num_players = shared_data->num_players;
+    memset(shared_data->cell_count, 0, sizeof(shared_data->cell_count));
+    for (int i = 0; i < num_players; i++) {
+        if (!shared_data->is_alive[i]) continue;
+        for (int cell = 0; cell < BOARD_CELLS; cell++) {
+            shared_data->cell_count[cell] += bitboard_test(&shared_data->fleets[i].occupied, cell);
+        }
+    }
+    int start = 0;
+    for (int cell = 0; cell < BOARD_CELLS; cell++) {
+        shared_data->cell_start[cell] = start;
+        start += shared_data->cell_count[cell];
+        shared_data->cell_count[cell] = 0;
+    }
+    for (int i = 0; i < num_players; i++) {
+        if (!shared_data->is_alive[i]) continue;
+        for (int cell = 0; cell < BOARD_CELLS; cell++) {
+            if (bitboard_test(&shared_data->fleets[i].occupied, cell)) {
+                shared_data->cell_players[shared_data->cell_start[cell] + shared_data->cell_count[cell]++] = i;
             }
         }
     }
+}
+
+// Removes eliminated players from every cell of the index
+static void compact_cell_index(SharedData *shared_data) {
+    for (int cell = 0; cell < BOARD_CELLS; cell++) {
+        int *players = &shared_data->cell_players[shared_data->cell_start[cell]];
+        int kept = 0;
+        for (int k = 0; k < shared_data->cell_count[cell]; k++) {
+            if (shared_data->is_alive[players[k]]) {
+                players[kept++] = players[k];
+            }
+        }
+        shared_data->cell_count[cell] = kept;
+    }
+}
+
+// Runs the game in rounds. In each round every alive player process takes its
+// turn concurrently; between rounds the manager eliminates players whose
+// fleets are sunk. Two barrier phases per round: start and done.
+// Turns in a round are simultaneous on purpose: a player sunk during a round
+// still fires that round, where the old sequential loop skipped it.
+void game_manager(SharedData *shared_data, pid_t writer_pid) {
+    int num_players = shared_data->num_players;
+    int winner_pid = -1;
+    long rounds = 0, round_nanoseconds = 0, max_round_nanoseconds = 0;
+
+    barrier_wait(&shared_data->barrier); // Every fleet is placed
+    build_cell_index(shared_data);
+
+    while (true) {
+        eliminate_players(shared_data);
+
+        shared_data->round = rounds + 1;
+        struct timespec round_start;
+        clock_gettime(CLOCK_MONOTONIC, &round_start);
+        barrier_wait(&shared_data->barrier); // Players read their status and attack
+        if (shared_data->game_over) {
+            break;
+        }
+        barrier_wait(&shared_data->barrier); // Every turn of the round is done
+
+        long nanoseconds = elapsed_nanoseconds(&round_start);
+        rounds++;
+        round_nanoseconds += nanoseconds;
+        if (nanoseconds > max_round_nanoseconds) max_round_nanoseconds = nanoseconds;
+    }
+
+    // Only the players: the writer is reaped once the log is closed
+    for (int i = 0; i < num_players; i++) {
+        waitpid(shared_data->player_pids[i], NULL, 0);
+    }
 
     // Find the winner after the game ends
     for (int k = 0; k < num_players; k++) {
-        if (shared_data->players[k].is_alive) {
-            winner_pid = shared_data->players[k].player_pid;
+        if (shared_data->is_alive[k]) {
+            winner_pid = shared_data->player_pids[k];
             break;
         }
     }
 
-    if (winner_pid != -1) {
-        printf("\033[0;32mPlayer %d wins!\033[0m\n", winner_pid);
-        printf("Game Over\n");
-        exit(EXIT_SUCCESS);
+    // Turn latency metrics
+    long turns = 0, turn_nanoseconds = 0, max_turn_nanoseconds = 0;
+    for (int k = 0; k < num_players; k++) {
+        PlayerStats *stats = &shared_data->stats[k];
+        turns += stats->turns;
+        turn_nanoseconds += stats->turn_nanoseconds;
+        if (stats->max_turn_nanoseconds > max_turn_nanoseconds) max_turn_nanoseconds = stats->max_turn_nanoseconds;
     }
+
+    // Let the writer render every event before printing the metrics
+    log_event(shared_data, (GameEvent){.type = EVENT_GAME_OVER, .player = winner_pid});
+    __atomic_store_n(&shared_data->log.closed, true, __ATOMIC_RELEASE);
+    int writer_status;
+    if (waitpid(writer_pid, &writer_status, 0) == -1 || !WIFEXITED(writer_status) ||
+        WEXITSTATUS(writer_status) != 0) {
+        fprintf(stderr, "The log writer failed, some events were not logged\n");
+    }
+
+    printf("Rounds: %ld, round latency avg %.1f us, max %.1f us\n", rounds,
+           rounds ? round_nanoseconds / 1000.0 / rounds : 0.0, max_round_nanoseconds / 1000.0);
+    printf("Turns: %ld, turn latency avg %.1f us, max %.1f us\n", turns,
+           turns ? turn_nanoseconds / 1000.0 / turns : 0.0, max_turn_nanoseconds / 1000.0);
 }
 
+// Eliminates every alive player whose fleet is fully sunk and drops them from
+// the cell index. Eliminated processes exit on their own. Returns true when
+// the game is over.
+bool eliminate_players(SharedData *shared_data) {
+    bool eliminated = false;
+    for (int i = 0; i < shared_data->num_players; i++) {
+        if (!shared_data->is_alive[i]) {
+            continue; // Skip eliminated players
+        }
 
+        // Check if the player has lost all ships: every occupied cell was hit
+        bool has_lost_all_ships = bitboard_subset(&shared_data->fleets[i].occupied,
+                                                  &shared_data->attacked_ships[i].board);
+
+        if (has_lost_all_ships) {
+            log_event(shared_data, (GameEvent){.type = EVENT_ELIMINATED, .player = shared_data->player_pids[i]});
+            shared_data->is_alive[i] = false;
+            shared_data->remaining_players--;
+            eliminated = true;
+        }
+    }
+    if (eliminated) {
+        compact_cell_index(shared_data);
+    }
+    shared_data->game_over = shared_data->remaining_players <= 1;
+    return shared_data->game_over;
+}
 
+// One player's attack: a position it hasn't fired at yet, applied to every
+// other alive player with a ship there. Other players may be attacking at the
+// same time, so each target cell is claimed atomically before the hit is
+// resolved. Hunting players follow up a hit on anyone's ship with its
+// neighbours.
+void take_turn(SharedData *shared_data, int player_index, GameRng *rng) {
+    TargetList *target_list = &shared_data->targets[player_index];
+    int cell = target_list_next(target_list, rng);
+    int attack_x = cell / BOARD_SIZE, attack_y = cell % BOARD_SIZE;
+    log_event(shared_data, (GameEvent){.type = EVENT_ATTACK, .player = shared_data->player_pids[player_index],
+                                       .x = attack_x, .y = attack_y});
 
-int main() {
-    srand(time(NULL));
-    int num_players; 
-    do {
+    bool hit = false;
+    const int *targets = &shared_data->cell_players[shared_data->cell_start[cell]];
+    for (int k = 0; k < shared_data->cell_count[cell]; k++) {
+        int j = targets[k];
+        if (j != player_index && bitboard_claim(&shared_data->attacked_ships[j].board, cell)) {
+            hit |= attack_player(shared_data, j, attack_x, attack_y) != ATTACK_MISS;
+        }
+    }
+    if (hit && shared_data->strategies[player_index] == STRATEGY_HUNT) {
+        target_list_hunt_around(target_list, attack_x, attack_y);
+    }
+}
+
+// Body of each player's process: place the fleet, then take one turn per
+// round until eliminated or the game is over
+void player_process(SharedData *shared_data, int player_index) {
+    GameRng rng = splitmix64((uint64_t)time(NULL) ^ ((uint64_t)getpid() << 32)); // Seed with process ID
+    PlayerStats *stats = &shared_data->stats[player_index];
+    shared_data->player_pids[player_index] = getpid();
+    shared_data->is_alive[player_index] = true;
+    target_list_reset(&shared_data->targets[player_index]);
+    Fleet *fleet = &shared_data->fleets[player_index];
+    place_ships(fleet, &rng);
+    GameEvent placed = {.type = EVENT_FLEET, .player = shared_data->player_pids[player_index]};
+    for (int k = 0; k < NUM_SHIPS; k++) {
+        placed.fleet[k][0] = fleet->ships[k].components[0][0];
+        placed.fleet[k][1] = fleet->ships[k].components[0][1];
+        placed.fleet[k][2] = fleet->ships[k].vertical;
+    }
+    log_event(shared_data, placed);
+
+    barrier_wait(&shared_data->barrier); // Every fleet is placed
+
+    while (true) {
+        barrier_wait(&shared_data->barrier); // Round starts
+        if (shared_data->game_over || !shared_data->is_alive[player_index]) {
+            barrier_leave(&shared_data->barrier);
+            exit(EXIT_SUCCESS);
+        }
+
+        struct timespec turn_start;
+        clock_gettime(CLOCK_MONOTONIC, &turn_start);
+        take_turn(shared_data, player_index, &rng);
+        long nanoseconds = elapsed_nanoseconds(&turn_start);
+        stats->turns++;
+        stats->turn_nanoseconds += nanoseconds;
+        if (nanoseconds > stats->max_turn_nanoseconds) stats->max_turn_nanoseconds = nanoseconds;
+
+        barrier_wait(&shared_data->barrier); // Round done
+    }
+}
+
+int barrier_init(RoundBarrier *barrier, int parties) {
+    pthread_mutexattr_t mutex_attr;
+    pthread_condattr_t cond_attr;
+    pthread_mutexattr_init(&mutex_attr);
+    pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
+
+    int status = pthread_mutex_init(&barrier->mutex, &mutex_attr);
+    if (status == 0) {
+        status = pthread_cond_init(&barrier->cond, &cond_attr);
+    }
+    pthread_mutexattr_destroy(&mutex_attr);
+    pthread_condattr_destroy(&cond_attr);
+    barrier->parties = parties;
+    barrier->waiting = 0;
+    barrier->generation = 0;
+    return status;
+}
+
+static void barrier_release(RoundBarrier *barrier) {
+    barrier->waiting = 0;
+    barrier->generation++;
+    pthread_cond_broadcast(&barrier->cond);
+}
+
+void barrier_wait(RoundBarrier *barrier) {
+    pthread_mutex_lock(&barrier->mutex);
+    unsigned generation = barrier->generation;
+    if (++barrier->waiting == barrier->parties) {
+        barrier_release(barrier);
+    } else {
+        while (generation == barrier->generation) {
+            pthread_cond_wait(&barrier->cond, &barrier->mutex);
+        }
+    }
+    pthread_mutex_unlock(&barrier->mutex);
+}
+
+void barrier_leave(RoundBarrier *barrier) {
+    pthread_mutex_lock(&barrier->mutex);
+    barrier->parties--;
+    if (barrier->waiting > 0 && barrier->waiting == barrier->parties) {
+        barrier_release(barrier);
+    }
+    pthread_mutex_unlock(&barrier->mutex);
+}
+
+int event_log_init(EventLog *log) {
+    pthread_mutexattr_t mutex_attr;
+    pthread_mutexattr_init(&mutex_attr);
+    pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&mutex_attr, PTHREAD_MUTEX_ROBUST);
+    int status = pthread_mutex_init(&log->writer_lock, &mutex_attr);
+    pthread_mutexattr_destroy(&mutex_attr);
+    log->writer_gone = false;
+    return status;
+}
+
+// True while the writer process runs. The lock is only free before the
+// writer took it, which counts as alive; EOWNERDEAD means it exited or
+// crashed while holding it.
+static bool log_writer_alive(EventLog *log) {
+    if (__atomic_load_n(&log->writer_gone, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    int status = pthread_mutex_trylock(&log->writer_lock);
+    if (status == 0) {
+        pthread_mutex_unlock(&log->writer_lock);
+    } else if (status == EOWNERDEAD) {
+        __atomic_store_n(&log->writer_gone, true, __ATOMIC_RELEASE);
+        pthread_mutex_consistent(&log->writer_lock);
+        pthread_mutex_unlock(&log->writer_lock);
+        return false;
+    }
+    return status != ENOTRECOVERABLE;
+}
+
+// Appends an event to the shared log. Each producer reserves a position with
+// one atomic add and only waits if the writer is a whole ring behind. If the
+// writer is gone nobody will free the slot, so the event is dropped.
+void log_event(SharedData *shared_data, GameEvent event) {
+    if (!shared_data->log_events) {
+        return;
+    }
+    EventLog *log = &shared_data->log;
+    event.round = shared_data->round;
+    uint64_t position = __atomic_fetch_add(&log->head, 1, __ATOMIC_RELAXED);
+    LogSlot *slot = &log->slots[position & (LOG_CAPACITY - 1)];
+    while (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != position) {
+        if (!log_writer_alive(log)) {
+            return;
+        }
+        sched_yield(); // The ring is full
+    }
+    slot->event = event;
+    __atomic_store_n(&slot->sequence, position + 1, __ATOMIC_RELEASE);
+}
+
+// Takes the oldest event if it has been written. Only the writer calls it.
+bool event_log_pop(EventLog *log, GameEvent *event) {
+    uint64_t position = log->tail;
+    LogSlot *slot = &log->slots[position & (LOG_CAPACITY - 1)];
+    if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != position + 1) {
+        return false;
+    }
+    *event = slot->event;
+    __atomic_store_n(&slot->sequence, position + LOG_CAPACITY, __ATOMIC_RELEASE);
+    log->tail = position + 1;
+    return true;
+}
+
+void render_event(FILE *out, const GameEvent *event) {
+    switch (event->type) {
+        case EVENT_FLEET: {
+            int ship_sizes[NUM_SHIPS] = SHIP_SIZES;
+            fprintf(out, "Player %d's ship positions:\n", event->player);
+            for (int i = 0; i < NUM_SHIPS; i++) {
+                int x = event->fleet[i][0], y = event->fleet[i][1];
+                bool vertical = event->fleet[i][2];
+                fprintf(out, "Ship %d, size %d, [", i + 1, ship_sizes[i]);
+                for (int k = 0; k < ship_sizes[i]; k++) {
+                    fprintf(out, "[%d,%d]%s", vertical ? x + k : x, vertical ? y : y + k,
+                            k < ship_sizes[i] - 1 ? "," : "");
+                }
+                fprintf(out, "]\n");
+            }
+            fprintf(out, "\n");
+            break;
+        }
+        case EVENT_ATTACK:
+            fprintf(out, "Player %d is attacking position (%d, %d)\n", event->player, event->x, event->y);
+            break;
+        case EVENT_HIT:
+            fprintf(out, "Player %d's ship hit!\n", event->player);
+            break;
+        case EVENT_SUNK:
+            fprintf(out, "\033[0;33mPlayer %d's ship sunk!\033[0m\n", event->player);
+            if (event->ships_left > 0) {
+                fprintf(out, "Player %d has %d ship(s) left.\n", event->player, event->ships_left);
+            }
+            break;
+        case EVENT_ELIMINATED:
+            fprintf(out, "\033[0;31mPlayer %d has lost all ships and is eliminated!\033[0m\n", event->player);
+            break;
+        case EVENT_GAME_OVER:
+            if (event->player != -1) {
+                fprintf(out, "\033[0;32mPlayer %d wins!\033[0m\n", event->player);
+            } else {
+                fprintf(out, "All remaining players were eliminated in the same round, no winner.\n");
+            }
+            fprintf(out, "Game Over\n");
+            break;
+        default:
+            fprintf(out, "Unknown event %d\n", event->type);
+            break;
+    }
+}
+
+// Body of the writer process: drains the log until the manager closes it,
+// either rendering each event to stdout or appending it to a binary log.
+// Output is flushed whenever the log runs dry, so it still shows up live.
+void log_writer_process(EventLog *log, FILE *binary_log) {
+    static char buffer[1 << 16];
+    pthread_mutex_lock(&log->writer_lock); // Released by the kernel when this process exits
+    FILE *out = binary_log ? binary_log : stdout;
+    setvbuf(out, buffer, _IOFBF, sizeof(buffer));
+    if (binary_log) {
+        LogFileHeader header = {LOG_MAGIC, BOARD_SIZE, NUM_SHIPS, sizeof(GameEvent), 0};
+        fwrite(&header, sizeof(header), 1, binary_log);
+    }
+
+    GameEvent event;
+    while (true) {
+        // Every event is appended before the log is closed, so once it's
+        // closed the first failed pop means the log is drained
+        bool closed = __atomic_load_n(&log->closed, __ATOMIC_ACQUIRE);
+        if (event_log_pop(log, &event)) {
+            if (binary_log) {
+                fwrite(&event, sizeof(event), 1, binary_log);
+            } else {
+                render_event(stdout, &event);
+            }
+            continue;
+        }
+        if (closed) {
+            break;
+        }
+        fflush(out);
+        usleep(200);
+    }
+    if (fclose(out) != 0 && binary_log) {
+        perror("Error writing event log");
+        exit(EXIT_FAILURE);
+    }
+    exit(EXIT_SUCCESS);
+}
+
+// Renders a binary log written with --log
+int replay_log(const char *path) {
+    FILE *in = fopen(path, "rb");
+    if (!in) {
+        perror("Error opening event log");
+        return 1;
+    }
+    LogFileHeader header;
+    if (fread(&header, sizeof(header), 1, in) != 1 || memcmp(header.magic, LOG_MAGIC, sizeof(header.magic)) != 0 ||
+        header.board_size != BOARD_SIZE || header.num_ships != NUM_SHIPS || header.event_size != sizeof(GameEvent)) {
+        fprintf(stderr, "%s is not an event log of this build\n", path);
+        fclose(in);
+        return 1;
+    }
+    GameEvent event;
+    while (fread(&event, sizeof(event), 1, in) == 1) {
+        render_event(stdout, &event);
+    }
+    fclose(in);
+    return 0;
+}
+
+void print_usage(const char *program) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --bench                 measure attack resolution and target selection throughput\n"
+            "  --tournament GAMES      play GAMES headless games and report statistics\n"
+            "  --players P             players per game (asked interactively if omitted;\n"
+            "                          %d by default in tournaments)\n"
+            "  --workers W             tournament worker processes (default: all cores)\n"
+            "  --seed S                tournament seed (default: current time)\n"
+            "  --strategy LIST         comma-separated strategies assigned to the players in\n"
+            "                          turn: random (default) or hunt, which fires next to hits\n"
+            "  --log FILE              save the game's events to FILE instead of printing them\n"
+            "  --replay FILE           print the events saved in FILE\n",
+            program, TOURNAMENT_DEFAULT_PLAYERS);
+}
+
+int main(int argc, char *argv[]) {
+    static const struct option options[] = {
+        {"bench", no_argument, NULL, 'b'},
+        {"tournament", required_argument, NULL, 't'},
+        {"players", required_argument, NULL, 'p'},
+        {"workers", required_argument, NULL, 'w'},
+        {"seed", required_argument, NULL, 's'},
+        {"strategy", required_argument, NULL, 'S'},
+        {"log", required_argument, NULL, 'l'},
+        {"replay", required_argument, NULL, 'r'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+    long num_games = 0;
+    int num_players = 0;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int num_workers = cpus > 0 ? (int)cpus : 1;
+    uint64_t seed = (uint64_t)time(NULL);
+    AttackStrategy strategies[MAX_STRATEGIES] = {STRATEGY_RANDOM};
+    int num_strategies = 1;
+    const char *log_path = NULL;
+    int option;
+    while ((option = getopt_long(argc, argv, "", options, NULL)) != -1) {
+        switch (option) {
+            case 'b':
+                run_benchmark();
+                return 0;
+            case 't': num_games = atol(optarg); break;
+            case 'p': num_players = atoi(optarg); break;
+            case 'w': num_workers = atoi(optarg); break;
+            case 's': seed = strtoull(optarg, NULL, 10); break;
+            case 'S': num_strategies = parse_strategies(optarg, strategies); break;
+            case 'l': log_path = optarg; break;
+            case 'r': return replay_log(optarg);
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+    if (optind < argc || num_games < 0 || num_workers < 1 || num_strategies == 0 || (log_path && num_games > 0) ||
+        (num_players != 0 && (num_players < NUM_PLAYERS_MIN || num_players > NUM_PLAYERS_MAX))) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if (num_games > 0) {
+        run_tournament(num_games, num_players ? num_players : TOURNAMENT_DEFAULT_PLAYERS, num_workers, seed,
+                       strategies, num_strategies);
+        return 0;
+    }
+
+    while (num_players < NUM_PLAYERS_MIN || num_players > NUM_PLAYERS_MAX) {
         printf("Input the number of players (between %d and %d): ", NUM_PLAYERS_MIN, NUM_PLAYERS_MAX);
-        scanf("%d", &num_players);
-    } while (num_players < NUM_PLAYERS_MIN || num_players > NUM_PLAYERS_MAX);
+        if (scanf("%d", &num_players) != 1) {
+            return 1;
+        }
+    }
     
     printf("Number of players: %d\n", num_players);
 
-    int shmid = shmget(IPC_PRIVATE, sizeof(SharedData), IPC_CREAT | 0666);
-    if (shmid == -1) {
-        perror("Failed to create shared memory segment");
+    FILE *binary_log = NULL;
+    if (log_path && !(binary_log = fopen(log_path, "wb"))) {
+        perror("Error opening event log");
         exit(EXIT_FAILURE);
     }
 
-    SharedData *shared_data = (SharedData *)shmat(shmid, NULL, 0);
-    if (shared_data == (SharedData *)(-1)) {
-        perror("Failed to attach shared memory segment");
+    SharedData *shared_data = shared_data_create(num_players, true);
+    if (!shared_data) {
+        perror("Failed to create shared memory segment");
         exit(EXIT_FAILURE);
     }
 
-    for (int i = 0; i < BOARD_SIZE; i++) {
-        for (int j = 0; j < BOARD_SIZE; j++) {
-            shared_data->is_attacked[i][j] = false;
-        }
+    assign_strategies(shared_data, strategies, num_strategies);
+    shared_data->remaining_players = num_players;
+    shared_data->game_over = false;
+    shared_data->log_events = true;
+    if (barrier_init(&shared_data->barrier, num_players + 1) != 0) {
+        fprintf(stderr, "Failed to initialize the round barrier\n");
+        exit(EXIT_FAILURE);
+    }
+    if (event_log_init(&shared_data->log) != 0) {
+        fprintf(stderr, "Failed to initialize the event log\n");
+        exit(EXIT_FAILURE);
     }
 
-    shared_data->remaining_players = num_players;
+    fflush(stdout); // Don't let the children inherit buffered output
+    pid_t writer_pid = fork();
+    if (writer_pid < 0) {
+        perror("Failed to fork log writer process");
+        exit(EXIT_FAILURE);
+    } else if (writer_pid == 0) {
+        log_writer_process(&shared_data->log, binary_log);
+    }
+    if (binary_log) {
+        fclose(binary_log); // Only the writer uses it
+    }
 
     for (int i = 0; i < num_players; i++) {
         pid_t pid = fork();
@@ -145,143 +1019,376 @@ int main() {
             perror("Failed to fork player process");
             exit(EXIT_FAILURE);
         } else if (pid == 0) {
-            srand(time(NULL) ^ getpid()); // Seed the random number generator with process ID
-            Player *current_player = &shared_data->players[i];
-            current_player->player_pid = getpid();
-            current_player->is_alive = true;
-
-            // Initialize attacked positions and attacked ships matrices
-            for (int row = 0; row < BOARD_SIZE; row++) {
-                for (int col = 0; col < BOARD_SIZE; col++) {
-                    current_player->attacked_positions[row][col] = false;
-                    current_player->attacked_ships[row][col] = false;
-                }
+            player_process(shared_data, i);
+        }
+        shared_data->player_pids[i] = pid; // The player stores the same pid itself
+
+    }
+
+    // Game manager process
+    game_manager(shared_data, writer_pid);
+
+    // Cleanup shared memory
+    shared_data_destroy(shared_data);
+
+    return 0;
+}
+
+AttackResult attack_player(SharedData *shared_data, int target_index, int attack_x, int attack_y) {
+    Fleet *target_fleet = &shared_data->fleets[target_index];
+    pid_t target_pid = shared_data->player_pids[target_index];
+
+    AttackResult result = resolve_attack(target_fleet, attack_x, attack_y);
+    if (result == ATTACK_MISS || !shared_data->log_events) {
+        return result;
+    }
+    log_event(shared_data, (GameEvent){.type = EVENT_HIT, .player = target_pid});
+    if (result == ATTACK_SUNK) {
+        log_event(shared_data, (GameEvent){.type = EVENT_SUNK, .player = target_pid,
+                                           .ships_left = count_remaining_ships(target_fleet)});
+    }
+    return result;
+}
+
+// Applies an attack to the target's ships without printing anything. A single
+// test against the occupancy mask rules out misses before looking at ships.
+AttackResult resolve_attack(Fleet *fleet, int attack_x, int attack_y) {
+    int cell = CELL(attack_x, attack_y);
+    if (!bitboard_test(&fleet->occupied, cell)) {
+        return ATTACK_MISS;
+    }
+
+    // Other processes may hit other cells of the same ship concurrently, so
+    // the hit counter is atomic and only the last hit sinks the ship
+    for (int i = 0; i < NUM_SHIPS; i++) {
+        Ship *ship = &fleet->ships[i];
+        int size = __atomic_load_n(&ship->size, __ATOMIC_RELAXED);
+        if (size == 0 || !bitboard_test(&ship->mask, cell)) continue;
+
+        if (__atomic_add_fetch(&ship->hits, 1, __ATOMIC_RELAXED) == size) {
+            __atomic_store_n(&ship->size, 0, __ATOMIC_RELAXED);
+            return ATTACK_SUNK;
+        }
+        return ATTACK_HIT;
+    }
+    return ATTACK_MISS;
+}
+
+int count_remaining_ships(const Fleet *fleet) {
+    int remaining_ships = 0;
+    for (int k = 0; k < NUM_SHIPS; k++) {
+        if (fleet->ships[k].size != 0) {
+            remaining_ships++;
+        }
+    }
+    return remaining_ships;
+}
+
+// Lists the cells where a ship of the given size and orientation can start
+// without overlapping the fleet. Returns how many there are.
+static int free_positions(const Fleet *fleet, int ship_size, bool vertical, int *positions) {
+    int count = 0;
+    int max_x = vertical ? BOARD_SIZE - ship_size : BOARD_SIZE - 1;
+    int max_y = vertical ? BOARD_SIZE - 1 : BOARD_SIZE - ship_size;
+    for (int x = 0; x <= max_x; x++) {
+        for (int y = 0; y <= max_y; y++) {
+            if (!check_overlap(fleet, ship_size, x, y, vertical)) {
+                positions[count++] = CELL(x, y);
             }
+        }
+    }
+    return count;
+}
 
-            int ship_sizes[NUM_SHIPS] = SHIP_SIZES;
-            for (int j = 0; j < NUM_SHIPS; j++) {
-                bool vertical = rand() % 2 == 0;
-                int ship_size = ship_sizes[j];
-                int x, y;
-
-                do {
-                    if (vertical) {
-                        x = rand() % (BOARD_SIZE - ship_size + 1);
-                        y = rand() % BOARD_SIZE;
-                    } else {
-                        x = rand() % BOARD_SIZE;
-                        y = rand() % (BOARD_SIZE - ship_size + 1);
-                    }
-                } while (check_overlap(current_player, ship_size, x, y, vertical));
-
-                current_player->ships[j].size = ship_size;
-                current_player->ships[j].hits = 0;
-                current_player->ships[j].vertical = vertical;
-
-                for (int k = 0; k < ship_size; k++) {
-                    if (vertical) {
-                        current_player->ships[j].components[k][0] = x + k;
-                        current_player->ships[j].components[k][1] = y;
-                    } else {
-                        current_player->ships[j].components[k][0] = x;
-                        current_player->ships[j].components[k][1] = y + k;
-                    }
-                }
+// Places the fleet at random positions without overlaps. Each ship picks
+// uniformly among the free positions for a random orientation, or the other
+// orientation if that one has none. A ship of size s has
+// BOARD_SIZE * (BOARD_SIZE - s + 1) starts per orientation and each occupied
+// cell rules out at most s of them, so on a 10x10 board (at least 70 starts,
+// at most 14 * 4 ruled out) every ship finds room in one pass.
+void place_ships(Fleet *fleet, GameRng *rng) {
+    int ship_sizes[NUM_SHIPS] = SHIP_SIZES;
+    int positions[BOARD_CELLS];
+
+    memset(&fleet->occupied, 0, sizeof(Bitboard));
+    for (int j = 0; j < NUM_SHIPS; j++) {
+        bool vertical = random_below(rng, 2) == 0;
+        int ship_size = ship_sizes[j];
+
+        int count = free_positions(fleet, ship_size, vertical, positions);
+        if (count == 0) {
+            vertical = !vertical;
+            count = free_positions(fleet, ship_size, vertical, positions);
+        }
+        if (count == 0) {
+            fprintf(stderr, "The board is too small for the fleet\n");
+            exit(EXIT_FAILURE);
+        }
+        int start = positions[random_below(rng, count)];
+        int x = start / BOARD_SIZE, y = start % BOARD_SIZE;
+
+        Ship *ship = &fleet->ships[j];
+        ship->size = ship_size;
+        ship->hits = 0;
+        ship->vertical = vertical;
+        ship->mask = ship_mask(ship_size, x, y, vertical);
+        bitboard_or(&fleet->occupied, &ship->mask);
+
+        for (int k = 0; k < ship_size; k++) {
+            if (vertical) {
+                ship->components[k][0] = x + k;
+                ship->components[k][1] = y;
+            } else {
+                ship->components[k][0] = x;
+                ship->components[k][1] = y + k;
             }
-            print_ship_positions(current_player);
-            exit(EXIT_SUCCESS);
         }
     }
+}
 
-    for (int i = 0; i < num_players; i++) {
-        wait(NULL);
+bool check_overlap(const Fleet *fleet, int ship_size, int x, int y, bool vertical) {
+    Bitboard candidate = ship_mask(ship_size, x, y, vertical);
+    return bitboard_intersects(&candidate, &fleet->occupied);
+}
+
+Bitboard ship_mask(int ship_size, int x, int y, bool vertical) {
+    Bitboard mask = {0};
+    for (int k = 0; k < ship_size; k++) {
+        bitboard_set(&mask, vertical ? CELL(x + k, y) : CELL(x, y + k));
     }
+    return mask;
+}
 
-    // Game manager process
-    game_manager(shared_data, num_players);
-for (int i = 0; i < num_players; i++) {
-        wait(NULL);
+// Measures how many attacks per second resolve_attack handles. Fleets and
+// shot orders are generated up front so only the attacks are timed; every
+// game fires at each cell of the board once.
+static volatile long bench_sink;
+
+void run_benchmark(void) {
+    GameRng rng = splitmix64((uint64_t)time(NULL));
+    static Fleet fleets[BENCH_FLEETS];
+    static int orders[BENCH_FLEETS][BOARD_CELLS];
+    long expected_hits = 0;
+    for (int f = 0; f < BENCH_FLEETS; f++) {
+        place_ships(&fleets[f], &rng);
+        expected_hits += bitboard_popcount(&fleets[f].occupied);
+        for (int cell = 0; cell < BOARD_CELLS; cell++) {
+            orders[f][cell] = cell;
+        }
+        for (int i = BOARD_CELLS - 1; i > 0; i--) {
+            int j = random_below(&rng, i + 1);
+            int tmp = orders[f][i];
+            orders[f][i] = orders[f][j];
+            orders[f][j] = tmp;
+        }
     }
-    // Cleanup shared memory
-    if (shmdt(shared_data) == -1) {
-        perror("Failed to detach shared memory segment");
-        exit(EXIT_FAILURE);
+    expected_hits *= BENCH_GAMES / BENCH_FLEETS;
+
+    long attacks = 0, hits = 0;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int game = 0; game < BENCH_GAMES; game++) {
+        Fleet fleet = fleets[game % BENCH_FLEETS];
+        Bitboard attacked_ships = {0};
+        const int *order = orders[(game / BENCH_FLEETS) % BENCH_FLEETS];
+        for (int i = 0; i < BOARD_CELLS; i++) {
+            if (!bitboard_test(&attacked_ships, order[i])) {
+                hits += resolve_attack(&fleet, order[i] / BOARD_SIZE, order[i] % BOARD_SIZE) != ATTACK_MISS;
+                bitboard_set(&attacked_ships, order[i]);
+            }
+            attacks++;
+        }
     }
-    if (shmctl(shmid, IPC_RMID, NULL) == -1) {
-        perror("Failed to delete shared memory segment");
-        exit(EXIT_FAILURE);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("Board %dx%d, %d games, %ld attacks (%ld hits) in %.3f s: %.0f attacks/sec\n",
+           BOARD_SIZE, BOARD_SIZE, BENCH_GAMES, attacks, hits, seconds, attacks / seconds);
+    if (hits != expected_hits) {
+        printf("Warning: expected %ld hits\n", expected_hits);
     }
 
-    return 0;
+    // Target selection: time filling half of each board and the whole board;
+    // the difference is the cost of the picks on the fuller half
+    static TargetList targets;
+    double pick_seconds[2];
+    long checksum = 0;
+    for (int phase = 0; phase < 2; phase++) {
+        int picks = phase == 0 ? BOARD_CELLS / 2 : BOARD_CELLS;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int game = 0; game < BENCH_GAMES; game++) {
+            target_list_reset(&targets);
+            for (int i = 0; i < picks; i++) {
+                checksum += target_list_next(&targets, &rng);
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        pick_seconds[phase] = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    }
+    long half_picks = (long)BENCH_GAMES * (BOARD_CELLS / 2);
+    long full_picks = (long)BENCH_GAMES * BOARD_CELLS;
+    printf("Target selection: %.0f picks/sec on the emptier half of the board, %.0f on the fuller half\n",
+           half_picks / pick_seconds[0], (full_picks - half_picks) / (pick_seconds[1] - pick_seconds[0]));
+    bench_sink = checksum; // Keeps the picks from being optimized away
 }
 
-void attack_player(SharedData *shared_data, int attacker_index, int attack_x, int attack_y) {
-    Player *target_player = &shared_data->players[attacker_index];
+// Plays one whole game inside the calling process with the same rules as
+// game_manager: eliminations, then every alive player takes a turn. Turns run
+// one after another here but the round is still simultaneous, so a player
+// sunk earlier in the round fires too. Returns the winner's index, or -1 if
+// the last players were eliminated together.
+int play_headless_game(SharedData *game, GameRng *rng, int *rounds) {
+    int num_players = game->num_players;
+    for (int i = 0; i < num_players; i++) {
+        game->player_pids[i] = i + 1;
+        game->is_alive[i] = true;
+        place_ships(&game->fleets[i], rng);
+    }
+    for (int i = 0; i < num_players; i++) {
+        target_list_reset(&game->targets[i]);
+    }
+    memset(game->attacked_ships, 0, num_players * sizeof(PaddedBitboard));
+    build_cell_index(game);
+    game->remaining_players = num_players;
+    game->game_over = false;
+    game->log_events = false;
 
-    for (int i = 0; i < NUM_SHIPS; i++) {
-        Ship *ship = &target_player->ships[i];
-        if (ship->size == 0) continue;
-
-        for (int j = 0; j < ship->size; j++) {
-            if (attack_x == ship->components[j][0] && attack_y == ship->components[j][1]) {
-                ship->hits++;
-                printf("Player %d's ship hit!\n", target_player->player_pid);
-                if (ship->hits == ship->size) {
-                    ship->size = 0;
-                    printf("\033[0;33mPlayer %d's ship sunk!\033[0m\n", target_player->player_pid);
-                    
-                    // Count remaining ships for the target player
-                    int remaining_ships = 0;
-                    for (int k = 0; k < NUM_SHIPS; k++) {
-                        if (target_player->ships[k].size != 0) {
-                            remaining_ships++;
-                        }
-                    }
-                    if (remaining_ships > 0) {
-                        printf("Player %d has %d ship(s) left.\n", target_player->player_pid, remaining_ships);
-                    }
-                }
-                return;
+    *rounds = 0;
+    while (!eliminate_players(game)) {
+        for (int i = 0; i < num_players; i++) {
+            if (game->is_alive[i]) {
+                take_turn(game, i, rng);
             }
         }
+        (*rounds)++;
     }
+
+    for (int i = 0; i < num_players; i++) {
+        if (game->is_alive[i]) {
+            return i;
+        }
+    }
+    return -1;
 }
 
-void print_ship_positions(Player *player) {
-    printf("Player %d's ship positions:\n", player->player_pid);
-    for (int i = 0; i < NUM_SHIPS; i++) {
-        Ship *ship = &player->ships[i];
-        printf("Ship %d, size %d, [", i + 1, ship->size);
-        for (int j = 0; j < ship->size; j++) {
-            printf("[%d,%d]", ship->components[j][0], ship->components[j][1]);
-            if (j < ship->size - 1) {
-                printf(",");
+static void tournament_worker(TournamentStats *stats, long num_games, int num_players, int worker,
+                              int num_workers, uint64_t seed, const AttackStrategy *strategies,
+                              int num_strategies) {
+    SharedData *game = shared_data_create(num_players, false);
+    if (!game) {
+        perror("Failed to allocate game state");
+        exit(EXIT_FAILURE);
+    }
+    assign_strategies(game, strategies, num_strategies);
+    for (long g = worker; g < num_games; g += num_workers) {
+        GameRng rng = splitmix64(seed ^ splitmix64((uint64_t)g));
+        int rounds;
+        int winner = play_headless_game(game, &rng, &rounds);
+
+        stats->games++;
+        stats->total_rounds += rounds;
+        stats->rounds_histogram[rounds]++;
+        for (int i = 0; i < num_players; i++) {
+            stats->ships_sunk += NUM_SHIPS - count_remaining_ships(&game->fleets[i]);
+        }
+        if (winner < 0) {
+            stats->draws++;
+            continue;
+        }
+        stats->wins[winner]++;
+        for (int k = 0; k < NUM_SHIPS; k++) {
+            if (game->fleets[winner].ships[k].size != 0) {
+                stats->winner_ships_alive[k]++;
             }
         }
-        printf("]\n");
     }
-    printf("\n");
+    shared_data_destroy(game);
 }
 
-bool check_overlap(Player *player, int ship_size, int x, int y, bool vertical) {
-    for (int i = 0; i < NUM_SHIPS; i++) {
-        Ship *ship = &player->ships[i];
-        if (ship->size == 0) continue;
+// Plays num_games games split over worker processes and prints win rates,
+// game lengths and ship survival. Each worker accumulates into its own slot
+// of a shared memory segment that the parent sums up at the end.
+void run_tournament(long num_games, int num_players, int num_workers, uint64_t seed,
+                    const AttackStrategy *strategies, int num_strategies) {
+    int shmid = shmget(IPC_PRIVATE, sizeof(TournamentStats) * num_workers, IPC_CREAT | 0666);
+    if (shmid == -1) {
+        perror("Failed to create shared memory segment");
+        exit(EXIT_FAILURE);
+    }
+    TournamentStats *worker_stats = (TournamentStats *)shmat(shmid, NULL, 0);
+    if (worker_stats == (TournamentStats *)(-1)) {
+        perror("Failed to attach shared memory segment");
+        exit(EXIT_FAILURE);
+    }
+    shmctl(shmid, IPC_RMID, NULL); // Freed once every process detaches
 
-        for (int j = 0; j < ship->size; j++) {
-            int ship_x = ship->components[j][0];
-            int ship_y = ship->components[j][1];
-            
-            if (vertical) {
-                if (x <= ship_x && ship_x < x + ship_size && y == ship_y) {
-                    return true;
-                }
-            } else {
-                if (x == ship_x && y <= ship_y && ship_y < y + ship_size) {
-                    return true;
-                }
-            }
+    printf("Tournament: %ld games, %d players, %d workers, seed %llu\n", num_games, num_players, num_workers,
+           (unsigned long long)seed);
+    fflush(stdout);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int w = 0; w < num_workers; w++) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("Failed to fork tournament worker");
+            exit(EXIT_FAILURE);
+        } else if (pid == 0) {
+            tournament_worker(&worker_stats[w], num_games, num_players, w, num_workers, seed, strategies,
+                              num_strategies);
+            exit(EXIT_SUCCESS);
+        }
+    }
+    for (int w = 0; w < num_workers; w++) {
+        int status;
+        if (wait(&status) == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "A tournament worker failed\n");
+            exit(EXIT_FAILURE);
         }
     }
-    return false;
+    double seconds = elapsed_nanoseconds(&start) / 1e9;
+
+    TournamentStats total = {0};
+    for (int w = 0; w < num_workers; w++) {
+        TournamentStats *stats = &worker_stats[w];
+        total.games += stats->games;
+        total.draws += stats->draws;
+        total.total_rounds += stats->total_rounds;
+        total.ships_sunk += stats->ships_sunk;
+        for (int r = 0; r <= MAX_ROUNDS; r++) total.rounds_histogram[r] += stats->rounds_histogram[r];
+        for (int i = 0; i < num_players; i++) total.wins[i] += stats->wins[i];
+        for (int k = 0; k < NUM_SHIPS; k++) total.winner_ships_alive[k] += stats->winner_ships_alive[k];
+    }
+    shmdt(worker_stats);
+
+    long decided = total.games - total.draws;
+    printf("Played %ld games in %.3f s: %.0f games/sec\n", total.games, seconds, total.games / seconds);
+    printf("Draws: %ld (%.2f%%)\n", total.draws, 100.0 * total.draws / total.games);
+    printf("Win rate by player:\n");
+    for (int i = 0; i < num_players; i++) {
+        printf("  Player %d (%s): %.2f%%\n", i + 1, strategy_names[strategies[i % num_strategies]],
+               100.0 * total.wins[i] / total.games);
+    }
+
+    int min_rounds = -1, max_rounds = 0, median_rounds = 0;
+    long seen = 0;
+    for (int r = 0; r <= MAX_ROUNDS; r++) {
+        if (total.rounds_histogram[r] == 0) continue;
+        if (min_rounds < 0) min_rounds = r;
+        max_rounds = r;
+        if (seen < (total.games + 1) / 2 && seen + total.rounds_histogram[r] >= (total.games + 1) / 2) {
+            median_rounds = r;
+        }
+        seen += total.rounds_histogram[r];
+    }
+    printf("Game length (rounds): avg %.2f, median %d, min %d, max %d\n",
+           (double)total.total_rounds / total.games, median_rounds, min_rounds, max_rounds);
+
+    int ship_sizes[NUM_SHIPS] = SHIP_SIZES;
+    printf("Ships sunk per game: %.2f of %d\n", (double)total.ships_sunk / total.games, NUM_SHIPS * num_players);
+    printf("Survival of the winner's ships:\n");
+    for (int k = 0; k < NUM_SHIPS; k++) {
+        printf("  Ship %d (size %d): %.2f%%\n", k + 1, ship_sizes[k],
+               decided ? 100.0 * total.winner_ships_alive[k] / decided : 0.0);
+    }
 }
@@ -1,13 +1,30 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <pthread.h>
 #include <semaphore.h>
+#include <stdatomic.h>
+#include <getopt.h>
 #include <time.h>
 #include <limits.h>
 #include <unistd.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
-#define NUM_NODES 20
-#define MAX_ROUTE_LENGTH NUM_NODES
+// Rutas largas se imprimen abreviadas (primeros y últimos nodos)
+#define ROUTE_PRINT_LIMIT 20
+
+// Feromonas por arista en punto fijo: PHEROMONE_ONE equivale a 1.0
+#define PHEROMONE_ONE (1u << 16)
+#define PHEROMONE_MIN (PHEROMONE_ONE / 64)
+#define PHEROMONE_MAX (1u << 30)
+// Segundos entre evaporaciones de la tabla
+#define EVAPORATION_PERIOD 0.25
+// En modo reproducible (-s) la evaporación depende de las caminatas, no del reloj
+#define EVAPORATION_WALKS 10000
 
 // Aristas del grafo
 typedef struct {
@@ -17,227 +34,1274 @@ typedef struct {
     sem_t semaphore;
 } Edge;
 
-// Grafo
+// Grafo en formato CSR: las aristas que salen del nodo u están contiguas en
+// edges[offsets[u]] .. edges[offsets[u + 1] - 1]
 typedef struct {
     int numNodes;
     int numEdges;
+    int *offsets;
     Edge *edges;
 } Graph;
 
-// ID Threads
+// Arista leída del archivo, antes de construir el CSR
+typedef struct {
+    int source;
+    int destination;
+    int cost;
+} RawEdge;
+
+// Trozo del archivo mapeado que procesa un thread del parser
+typedef struct {
+    const char *begin;
+    const char *end;
+    int dimacs;
+    RawEdge *out;
+    long count;
+    int max_node;
+    long bad_lines;
+} ParseChunk;
+
+// ID Threads y contadores para la telemetría. Cada thread escribe sólo los
+// suyos, alineados para que no compartan línea de caché. walks cuenta las
+// caminatas completas; las que la poda corta se cuentan sólo en pruned.
 typedef struct {
-    int id;
+    _Alignas(64) int id;
     Graph *graph;
+    atomic_ulong walks;
+    atomic_ulong arrivals;
+    atomic_ulong pruned;
+    atomic_ulong improvements;
 } Threads;
 
+// Condiciones de término; un valor 0 (o -1 en target_cost) las desactiva
+typedef struct {
+    double time_budget;
+    double stall_window;
+    int target_cost;
+    int stop_at_lower_bound;
+    double report_interval;
+} StopConditions;
+
+// Resumen de una ejecución de la búsqueda
+typedef struct {
+    int num_threads;
+    int semaphore_limit;
+    int pheromones;
+    double seconds;
+    unsigned long walks;
+    unsigned long pruned;
+    int best_cost;
+} SearchResult;
+
+// Punto de la evolución del mejor costo
+typedef struct {
+    double seconds;
+    int cost;
+    int thread;
+} CostSample;
+
+// Grafo por defecto cuando no se entrega un archivo
+static const RawEdge default_edges[] = {
+    {0, 1, 1}, {0, 2, 2}, {1, 3, 3}, {1, 4, 1}, {2, 4, 2},
+    {2, 5, 3}, {3, 6, 1}, {3, 7, 2}, {4, 7, 3}, {4, 8, 1},
+    {5, 8, 2}, {5, 9, 3}, {6, 10, 1}, {7, 10, 2}, {7, 11, 3},
+    {8, 11, 1}, {8, 12, 2}, {9, 12, 3}, {9, 13, 1}, {10, 14, 2},
+    {11, 14, 3}, {11, 15, 1}, {12, 15, 2}, {12, 16, 3}, {13, 16, 1},
+    {13, 17, 2}, {14, 18, 3}, {15, 18, 1}, {16, 18, 2}, {18, 19, 3}
+};
+
 // Variables globales
-int global_min_cost = INT_MAX;
-int global_min_route[MAX_ROUTE_LENGTH];
+atomic_int global_min_cost = INT_MAX;
+int *global_min_route;
 int global_min_route_length = 0;
 pthread_mutex_t min_cost_mutex;
-volatile int stop_threads = 0;
-time_t start_time;
-int thread_with_min_cost = -1; 
+atomic_int stop_threads = 0;
+const char *stop_reason = "";
+struct timespec start_time;
+int thread_with_min_cost = -1;
+unsigned long walk_with_min_cost = 0;
+StopConditions stop_conditions = {60, 0, -1, 0, 0};
+int lower_bound = INT_MAX;
+
+// Distancia mínima de cada nodo al nodo final. Es una cota admisible del costo
+// restante: si el costo parcial más esa cota supera al mejor costo conocido,
+// la caminata no puede mejorar y se abandona. NULL con --sin-poda.
+int *distance_to_finish;
+double last_improvement_time = 0;
+CostSample *cost_history;
+int cost_history_length = 0;
+int cost_history_capacity = 0;
+
+// Opciones de la búsqueda. Con una semilla fija y un número de caminatas por
+// thread (sin límite de tiempo) el resultado es idéntico entre ejecuciones:
+// cada caminata usa su propio generador derivado de (semilla, thread, número
+// de caminata) y los empates se resuelven por thread y caminata.
+uint64_t search_seed;
+int deterministic = 0;
+unsigned long walk_budget = 0;
+useconds_t walk_pause = 10000;
+int verbose = 1;
+FILE *log_stream;
+atomic_int finished_threads = 0;
+
+// Tabla de feromonas estilo colonia de hormigas, indexada igual que
+// graph->edges. Los threads depositan sin locks al llegar al final y el
+// thread principal la evapora periódicamente; con -s la evapora el thread
+// que completa cada EVAPORATION_WALKS caminatas, para no depender del reloj.
+// Aun así con feromonas los threads se influyen entre sí según cómo los
+// planifique el sistema, así que el modo reproducible sólo vale para -n 1
+// con un número fijo de caminatas.
+atomic_uint *pheromones;
+atomic_ulong evaporation_walks;
+int use_pheromones = 0;
+double evaporation_rate = 0.1;
+
+static uint64_t splitmix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+static uint32_t next_random(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return (uint32_t)(*state >> 32);
+}
+
+double elapsed_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start_time.tv_sec) + (now.tv_nsec - start_time.tv_nsec) / 1e9;
+}
+
+// Sólo el primer aviso de término queda registrado como motivo
+void request_stop(const char *reason) {
+    int expected = 0;
+    if (atomic_compare_exchange_strong(&stop_threads, &expected, 1)) {
+        stop_reason = reason;
+    }
+}
+
+// Se llama con min_cost_mutex tomado
+void record_improvement(int cost, int thread_id) {
+    double now = elapsed_seconds();
+    last_improvement_time = now;
+    if (cost_history_length == cost_history_capacity) {
+        int capacity = cost_history_capacity ? cost_history_capacity * 2 : 64;
+        CostSample *history = (CostSample *)realloc(cost_history, capacity * sizeof(CostSample));
+        if (!history) {
+            return;
+        }
+        cost_history = history;
+        cost_history_capacity = capacity;
+    }
+    cost_history[cost_history_length++] = (CostSample){now, cost, thread_id};
+}
+
+void print_route(const int *route, int length) {
+    for (int i = 0; i < length; i++) {
+        if (length > ROUTE_PRINT_LIMIT && i == ROUTE_PRINT_LIMIT / 2) {
+            printf("... ");
+            i = length - ROUTE_PRINT_LIMIT / 2;
+        }
+        printf("%d ", route[i]);
+    }
+}
+
+// Elige la siguiente arista con probabilidad proporcional a feromona / costo
+static int choose_weighted_edge(const Graph *graph, int first_edge, int num_neighbors, uint64_t *rng) {
+    double total = 0;
+    for (int i = first_edge; i < first_edge + num_neighbors; i++) {
+        unsigned tau = atomic_load_explicit(&pheromones[i], memory_order_relaxed);
+        total += (double)(tau < PHEROMONE_MIN ? PHEROMONE_MIN : tau) / (graph->edges[i].cost + 1);
+    }
+    double pick = next_random(rng) * (total / 4294967296.0);
+    for (int i = first_edge; i < first_edge + num_neighbors - 1; i++) {
+        unsigned tau = atomic_load_explicit(&pheromones[i], memory_order_relaxed);
+        pick -= (double)(tau < PHEROMONE_MIN ? PHEROMONE_MIN : tau) / (graph->edges[i].cost + 1);
+        if (pick < 0) {
+            return i;
+        }
+    }
+    return first_edge + num_neighbors - 1;
+}
+
+// Refuerza las aristas de una ruta completa en proporción a mejor / costo,
+// saturando en PHEROMONE_MAX. El compare-and-swap evita que dos depósitos
+// concurrentes pasen juntos del máximo y den la vuelta al entero.
+static void deposit_pheromones(const int *route_edges, int num_edges, int cost) {
+    int best = atomic_load_explicit(&global_min_cost, memory_order_relaxed);
+    if (best == INT_MAX || cost == 0) {
+        best = cost = 1;
+    }
+    double ratio = (double)PHEROMONE_ONE * best / cost;
+    unsigned amount = ratio >= PHEROMONE_MAX ? PHEROMONE_MAX : (unsigned)ratio;
+    for (int i = 0; i < num_edges; i++) {
+        atomic_uint *tau = &pheromones[route_edges[i]];
+        unsigned current = atomic_load_explicit(tau, memory_order_relaxed);
+        unsigned next;
+        do {
+            if (current >= PHEROMONE_MAX) {
+                break;
+            }
+            next = current + amount > PHEROMONE_MAX ? PHEROMONE_MAX : current + amount;
+        } while (!atomic_compare_exchange_weak_explicit(tau, &current, next, memory_order_relaxed,
+                                                        memory_order_relaxed));
+    }
+}
+
+// Resta una fracción de cada feromona con compare-and-swap, así un depósito
+// o una evaporación concurrente nunca se pierde ni hace pasar el valor bajo 0
+void evaporate_pheromones(const Graph *graph) {
+    unsigned rate = (unsigned)(evaporation_rate * PHEROMONE_ONE);
+    for (int i = 0; i < graph->numEdges; i++) {
+        unsigned tau = atomic_load_explicit(&pheromones[i], memory_order_relaxed);
+        while (tau > PHEROMONE_MIN &&
+               !atomic_compare_exchange_weak_explicit(&pheromones[i], &tau,
+                                                      tau - (unsigned)(((uint64_t)tau * rate) >> 16),
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+        }
+    }
+}
 
 // Función principal de encontrar la ruta con menor costo
 void *find_route(void *args) {
     Threads *thread = (Threads *)args;
     Graph *graph = thread->graph;
+    int finish_node = graph->numNodes - 1;
+
+    // Una ruta simple no repite nodos; en grafos con ciclos la caminata se
+    // abandona si supera ese largo
+    int *route = (int *)malloc(graph->numNodes * sizeof(int));
+    int *route_edges = use_pheromones ? (int *)malloc(graph->numNodes * sizeof(int)) : NULL;
+    if (!route || (use_pheromones && !route_edges)) {
+        perror("Error allocating memory for route");
+        free(route);
+        atomic_fetch_add(&finished_threads, 1);
+        pthread_exit(NULL);
+    }
+
+    uint64_t thread_seed = splitmix64(search_seed + (uint64_t)thread->id);
 
-    while (!stop_threads) {
-        if (difftime(time(NULL), start_time) >= 60) {
-            stop_threads = 1;
+    for (unsigned long walk = 0; !atomic_load_explicit(&stop_threads, memory_order_relaxed); walk++) {
+        if (walk_budget > 0 && walk == walk_budget) {
             break;
         }
+        uint64_t rng = splitmix64(thread_seed + walk) | 1;
         int current_node = 0;
-        int finish_node = graph->numNodes - 1;
-        int *route = (int *)malloc(graph->numNodes * sizeof(int));
-        if (!route) {
-            perror("Error allocating memory for route");
-            pthread_exit(NULL);
-        }
         int route_index = 0;
         int total_cost = 0;
+        int pruned = 0;
         route[route_index++] = current_node;
 
         while (current_node != finish_node) {
-            int *neighbors = (int *)malloc(graph->numNodes * sizeof(int));
-            if (!neighbors) {
-                perror("Error allocating memory for neighbors");
-                free(route);
-                pthread_exit(NULL);
-            }
-            int num_neighbors = 0;
-            int next_edge_index = -1;
+            int first_edge = graph->offsets[current_node];
+            int num_neighbors = graph->offsets[current_node + 1] - first_edge;
 
-            for (int i = 0; i < graph->numEdges; i++) {
-                if (graph->edges[i].source == current_node) {
-                    neighbors[num_neighbors++] = graph->edges[i].destination;
-                }
-            }
-
-            if (num_neighbors == 0) {
-                free(neighbors);
+            if (num_neighbors == 0 || route_index == graph->numNodes) {
                 break;
             }
 
-            int next_node_index = rand() % num_neighbors;
-            int next_node = neighbors[next_node_index];
-
-            for (int i = 0; i < graph->numEdges; i++) {
-                if (graph->edges[i].source == current_node && graph->edges[i].destination == next_node) {
-                    next_edge_index = i;
-                    break;
-                }
+            int edge_index;
+            if (use_pheromones) {
+                edge_index = choose_weighted_edge(graph, first_edge, num_neighbors, &rng);
+                route_edges[route_index - 1] = edge_index;
+            } else {
+                edge_index = first_edge + next_random(&rng) % num_neighbors;
             }
+            Edge *edge = &graph->edges[edge_index];
 
-            free(neighbors);
-
-            if (next_edge_index == -1) {
+            if (distance_to_finish &&
+                (long)total_cost + edge->cost + distance_to_finish[edge->destination] >
+                    atomic_load_explicit(&global_min_cost, memory_order_relaxed)) {
+                atomic_fetch_add_explicit(&thread->pruned, 1, memory_order_relaxed);
+                pruned = 1;
                 break;
             }
 
-            sem_wait(&(graph->edges[next_edge_index].semaphore));
-            total_cost += graph->edges[next_edge_index].cost;
-            route[route_index++] = next_node;
-            current_node = next_node;
-            sem_post(&(graph->edges[next_edge_index].semaphore));
+            sem_wait(&edge->semaphore);
+            total_cost += edge->cost;
+            route[route_index++] = edge->destination;
+            current_node = edge->destination;
+            sem_post(&edge->semaphore);
+        }
+
+        if (!pruned) {
+            atomic_fetch_add_explicit(&thread->walks, 1, memory_order_relaxed);
         }
 
         if (current_node == finish_node) {
+            atomic_fetch_add_explicit(&thread->arrivals, 1, memory_order_relaxed);
+            if (use_pheromones) {
+                deposit_pheromones(route_edges, route_index - 1, total_cost);
+            }
+        }
+        if (use_pheromones && deterministic &&
+            atomic_fetch_add_explicit(&evaporation_walks, 1, memory_order_relaxed) % EVAPORATION_WALKS ==
+                EVAPORATION_WALKS - 1) {
+            evaporate_pheromones(graph);
+        }
+
+        if (current_node == finish_node &&
+            total_cost <= atomic_load_explicit(&global_min_cost, memory_order_relaxed)) {
             pthread_mutex_lock(&min_cost_mutex);
-            if (total_cost < global_min_cost) {
-                global_min_cost = total_cost;
+            int best = atomic_load(&global_min_cost);
+            if (deterministic && total_cost == best && (thread->id < thread_with_min_cost ||
+                                       (thread->id == thread_with_min_cost && walk < walk_with_min_cost))) {
+                global_min_route_length = route_index;
+                memcpy(global_min_route, route, route_index * sizeof(int));
+                thread_with_min_cost = thread->id;
+                walk_with_min_cost = walk;
+            } else if (total_cost < best) {
+                atomic_store(&global_min_cost, total_cost);
                 global_min_route_length = route_index;
                 for (int i = 0; i < route_index; i++) {
                     global_min_route[i] = route[i];
                 }
-                thread_with_min_cost = thread->id; 
-                printf("Thread %d encontró un nuevo costo mínimo: %d, Con la ruta: ", thread->id, global_min_cost);
-                for (int i = 0; i < global_min_route_length; i++) {
-                    printf("%d ", global_min_route[i]);
+                thread_with_min_cost = thread->id;
+                walk_with_min_cost = walk;
+                atomic_fetch_add_explicit(&thread->improvements, 1, memory_order_relaxed);
+                record_improvement(total_cost, thread->id);
+                if (verbose) {
+                    printf("Thread %d encontró un nuevo costo mínimo: %d, Con la ruta: ", thread->id, total_cost);
+                    print_route(global_min_route, global_min_route_length);
+                    printf("\n");
+                }
+
+                if (stop_conditions.target_cost >= 0 && total_cost <= stop_conditions.target_cost) {
+                    request_stop("se alcanzó el costo objetivo");
+                } else if (total_cost == lower_bound) {
+                    request_stop("se alcanzó la cota inferior exacta");
                 }
-                printf("\n");
             }
             pthread_mutex_unlock(&min_cost_mutex);
         }
-        usleep(10000);
-        free(route);
+        if (walk_pause > 0) {
+            usleep(walk_pause);
+        }
     }
 
+    atomic_fetch_add(&finished_threads, 1);
+    free(route_edges);
+    free(route);
     return NULL;
 }
 
-int main() {
-    srand(time(NULL));
+// Construye el CSR a partir de la lista de aristas leída
+int build_graph(Graph *graph, const RawEdge *raw, int num_edges, int num_nodes) {
+    graph->numNodes = num_nodes;
+    graph->numEdges = num_edges;
+    graph->offsets = (int *)calloc((size_t)num_nodes + 1, sizeof(int));
+    graph->edges = (Edge *)malloc((size_t)num_edges * sizeof(Edge));
+    int *next = (int *)malloc((size_t)num_nodes * sizeof(int));
+    if (!graph->offsets || !graph->edges || !next) {
+        perror("Error allocating memory for graph");
+        free(next);
+        return -1;
+    }
 
-    int num_threads;
-    int semaphore_limit;
+    for (int i = 0; i < num_edges; i++) {
+        graph->offsets[raw[i].source + 1]++;
+    }
+    for (int u = 0; u < num_nodes; u++) {
+        graph->offsets[u + 1] += graph->offsets[u];
+        next[u] = graph->offsets[u];
+    }
+    for (int i = 0; i < num_edges; i++) {
+        Edge *edge = &graph->edges[next[raw[i].source]++];
+        edge->source = raw[i].source;
+        edge->destination = raw[i].destination;
+        edge->cost = raw[i].cost;
+    }
 
-    do {
-        printf("Ingrese el valor N correspondiente a la cantidad de Threads (5, 10, o 20): ");
-        scanf("%d", &num_threads);
-    } while (num_threads != 5 && num_threads != 10 && num_threads != 20);
+    free(next);
+    return 0;
+}
+
+void free_graph(Graph *graph) {
+    free(graph->offsets);
+    free(graph->edges);
+}
+
+// Entrada del heap de Dijkstra
+typedef struct {
+    int distance;
+    int node;
+} HeapEntry;
+
+static void heap_push(HeapEntry *heap, int *size, HeapEntry entry) {
+    int i = (*size)++;
+    while (i > 0 && heap[(i - 1) / 2].distance > entry.distance) {
+        heap[i] = heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap[i] = entry;
+}
+
+static HeapEntry heap_pop(HeapEntry *heap, int *size) {
+    HeapEntry top = heap[0];
+    HeapEntry last = heap[--(*size)];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= *size) break;
+        if (child + 1 < *size && heap[child + 1].distance < heap[child].distance) child++;
+        if (heap[child].distance >= last.distance) break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = last;
+    return top;
+}
+
+// Distancia mínima desde cada nodo hasta el nodo final, con Dijkstra sobre el
+// grafo invertido. Los nodos que no llegan al final quedan en INT_MAX.
+int *compute_distances_to_finish(const Graph *graph) {
+    int num_nodes = graph->numNodes;
+    int *distances = (int *)malloc((size_t)num_nodes * sizeof(int));
+    int *reverse_offsets = (int *)calloc((size_t)num_nodes + 1, sizeof(int));
+    RawEdge *reverse_edges = (RawEdge *)malloc((size_t)graph->numEdges * sizeof(RawEdge));
+    HeapEntry *heap = (HeapEntry *)malloc(((size_t)graph->numEdges + 1) * sizeof(HeapEntry));
+    if (!distances || !reverse_offsets || !reverse_edges || !heap) {
+        perror("Error allocating memory for distances");
+        free(distances);
+        free(reverse_offsets);
+        free(reverse_edges);
+        free(heap);
+        return NULL;
+    }
+
+    for (int i = 0; i < graph->numEdges; i++) {
+        reverse_offsets[graph->edges[i].destination + 1]++;
+    }
+    for (int v = 0; v < num_nodes; v++) {
+        reverse_offsets[v + 1] += reverse_offsets[v];
+        distances[v] = reverse_offsets[v];
+    }
+    for (int i = 0; i < graph->numEdges; i++) {
+        const Edge *edge = &graph->edges[i];
+        reverse_edges[distances[edge->destination]++] = (RawEdge){edge->destination, edge->source, edge->cost};
+    }
+
+    for (int v = 0; v < num_nodes; v++) {
+        distances[v] = INT_MAX;
+    }
+    int heap_size = 0;
+    distances[num_nodes - 1] = 0;
+    heap_push(heap, &heap_size, (HeapEntry){0, num_nodes - 1});
+    while (heap_size > 0) {
+        HeapEntry top = heap_pop(heap, &heap_size);
+        if (top.distance > distances[top.node]) {
+            continue;
+        }
+        for (int i = reverse_offsets[top.node]; i < reverse_offsets[top.node + 1]; i++) {
+            long candidate = (long)top.distance + reverse_edges[i].cost;
+            int node = reverse_edges[i].destination;
+            if (candidate < distances[node]) {
+                distances[node] = (int)candidate;
+                heap_push(heap, &heap_size, (HeapEntry){(int)candidate, node});
+            }
+        }
+    }
+
+    free(reverse_offsets);
+    free(reverse_edges);
+    free(heap);
+    return distances;
+}
+
+// Elimina las aristas que llevan a nodos sin camino al nodo final, así las
+// caminatas nunca entran a un callejón sin salida. Se hace antes de
+// inicializar los semáforos porque mueve las aristas. Retorna cuántas quitó.
+int prune_dead_ends(Graph *graph, const int *distances) {
+    int kept = 0;
+    for (int u = 0; u < graph->numNodes; u++) {
+        int first_edge = graph->offsets[u];
+        graph->offsets[u] = kept;
+        if (distances[u] == INT_MAX) {
+            continue;
+        }
+        for (int i = first_edge; i < graph->offsets[u + 1]; i++) {
+            if (distances[graph->edges[i].destination] != INT_MAX) {
+                graph->edges[kept++] = graph->edges[i];
+            }
+        }
+    }
+    int removed = graph->numEdges - kept;
+    graph->offsets[graph->numNodes] = kept;
+    graph->numEdges = kept;
+    return removed;
+}
+
+// Línea periódica con caminatas por segundo, mejor costo y aporte de cada thread
+void print_telemetry(Threads *infos, int num_threads, double now, double interval,
+                     unsigned long *previous_walks) {
+    unsigned long total_walks = 0;
+    for (int i = 0; i < num_threads; i++) {
+        total_walks += atomic_load_explicit(&infos[i].walks, memory_order_relaxed);
+    }
+    int best = atomic_load(&global_min_cost);
+    fprintf(log_stream, "[%7.1f s] caminatas/s: %.0f | caminatas: %lu | mejor costo: ",
+            now, (total_walks - *previous_walks) / interval, total_walks);
+    if (best == INT_MAX) {
+        fprintf(log_stream, "-");
+    } else {
+        fprintf(log_stream, "%d", best);
+    }
+    fprintf(log_stream, " | threads:");
+    for (int i = 0; i < num_threads; i++) {
+        unsigned long walks = atomic_load_explicit(&infos[i].walks, memory_order_relaxed);
+        fprintf(log_stream, " %d:%.0f%%/%lu", infos[i].id, total_walks ? 100.0 * walks / total_walks : 0.0,
+                atomic_load_explicit(&infos[i].improvements, memory_order_relaxed));
+    }
+    fprintf(log_stream, "\n");
+    fflush(log_stream);
+    *previous_walks = total_walks;
+}
+
+// El thread principal vigila el tiempo y la ventana sin mejora; el costo
+// objetivo y la cota inferior los detectan los threads al mejorar la ruta.
+void monitor_search(Graph *graph, Threads *infos, int num_threads) {
+    const StopConditions *stop = &stop_conditions;
+    double next_report = stop->report_interval;
+    double next_evaporation = EVAPORATION_PERIOD;
+    double last_report = 0;
+    unsigned long previous_walks = 0;
+
+    while (!atomic_load(&stop_threads)) {
+        struct timespec tick = {0, 10 * 1000 * 1000};
+        nanosleep(&tick, NULL);
+        double now = elapsed_seconds();
+
+        if (atomic_load(&finished_threads) == num_threads) {
+            request_stop("se completaron las caminatas de todos los threads");
+        } else if (stop->time_budget > 0 && now >= stop->time_budget) {
+            request_stop("se agotó el tiempo");
+        } else if (stop->stall_window > 0) {
+            pthread_mutex_lock(&min_cost_mutex);
+            double idle = now - last_improvement_time;
+            pthread_mutex_unlock(&min_cost_mutex);
+            if (idle >= stop->stall_window) {
+                request_stop("no hubo mejoras en la ventana configurada");
+            }
+        }
+
+        if (use_pheromones && !deterministic && now >= next_evaporation) {
+            evaporate_pheromones(graph);
+            next_evaporation = elapsed_seconds() + EVAPORATION_PERIOD;
+        }
+
+        if (stop->report_interval > 0 && now >= next_report) {
+            print_telemetry(infos, num_threads, now, now - last_report, &previous_walks);
+            last_report = now;
+            next_report += stop->report_interval;
+        }
+    }
+}
+
+static const char *skip_blanks(const char *p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+        p++;
+    }
+    return p;
+}
+
+static const char *parse_int(const char *p, const char *end, long *value) {
+    p = skip_blanks(p, end);
+    int negative = 0;
+    if (p < end && *p == '-') {
+        negative = 1;
+        p++;
+    }
+    if (p == end || *p < '0' || *p > '9') {
+        return NULL;
+    }
+    // Los valores terminan en campos int; uno que no cabe invalida la línea
+    long v = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        int digit = *p++ - '0';
+        if (v > (INT_MAX - digit) / 10) {
+            return NULL;
+        }
+        v = v * 10 + digit;
+    }
+    *value = negative ? -v : v;
+    return p;
+}
+
+// Lee una línea "u v [costo]" (lista de aristas, nodos desde 0) o
+// "a u v costo" (DIMACS, nodos desde 1). Retorna 1 si la línea es una arista,
+// 0 si es comentario/cabecera y -1 si está mal formada.
+static int parse_edge_line(const char *p, const char *end, int dimacs, RawEdge *edge) {
+    p = skip_blanks(p, end);
+    if (p == end || *p == '\n' || *p == 'c' || *p == 'p' || *p == '#' || *p == '%') {
+        return 0;
+    }
+    if (*p == 'a') {
+        p++;
+    }
+
+    long u, v, cost = 1;
+    if (!(p = parse_int(p, end, &u)) || !(p = parse_int(p, end, &v))) {
+        return -1;
+    }
+    // El costo sólo es opcional en listas de aristas; si está, debe ser un
+    // entero válido y no puede venir nada más después
+    p = skip_blanks(p, end);
+    if (p < end) {
+        if (!(p = parse_int(p, end, &cost)) || skip_blanks(p, end) != end) {
+            return -1;
+        }
+    } else if (dimacs) {
+        return -1;
+    }
+    if (dimacs) {
+        u--;
+        v--;
+    }
+    if (u < 0 || v < 0 || u >= INT_MAX || v >= INT_MAX || cost < 0 || cost > INT_MAX) {
+        return -1;
+    }
+    edge->source = (int)u;
+    edge->destination = (int)v;
+    edge->cost = (int)cost;
+    return 1;
+}
+
+// Recorre el trozo línea por línea. En la primera pasada (out == NULL) sólo
+// cuenta aristas; en la segunda las escribe en out.
+void *parse_chunk(void *args) {
+    ParseChunk *chunk = (ParseChunk *)args;
+    const char *p = chunk->begin;
+    chunk->count = 0;
+    chunk->max_node = -1;
+    chunk->bad_lines = 0;
+
+    while (p < chunk->end) {
+        const char *line_end = memchr(p, '\n', chunk->end - p);
+        if (!line_end) {
+            line_end = chunk->end;
+        }
+        RawEdge edge;
+        int status = parse_edge_line(p, line_end, chunk->dimacs, &edge);
+        if (status == 1) {
+            if (chunk->out) {
+                chunk->out[chunk->count] = edge;
+            }
+            chunk->count++;
+            if (edge.source > chunk->max_node) chunk->max_node = edge.source;
+            if (edge.destination > chunk->max_node) chunk->max_node = edge.destination;
+        } else if (status == -1) {
+            chunk->bad_lines++;
+        }
+        p = line_end + 1;
+    }
+    return NULL;
+}
+
+// Ejecuta parse_chunk sobre todos los trozos en paralelo
+int run_parse_threads(ParseChunk *chunks, int num_chunks) {
+    pthread_t threads[num_chunks];
+    for (int i = 0; i < num_chunks; i++) {
+        if (pthread_create(&threads[i], NULL, parse_chunk, &chunks[i]) != 0) {
+            perror("Error in parser thread creation");
+            return -1;
+        }
+    }
+    for (int i = 0; i < num_chunks; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    return 0;
+}
+
+// Carga un grafo en formato lista de aristas o DIMACS (.gr). El archivo se
+// mapea en memoria y se divide en trozos que se procesan en paralelo.
+int load_graph(const char *path, Graph *graph) {
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        perror("Error opening graph file");
+        return -1;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        fprintf(stderr, "El archivo de grafo '%s' está vacío o no se puede leer\n", path);
+        close(fd);
+        return -1;
+    }
+    size_t size = (size_t)info.st_size;
+    const char *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        perror("Error mapping graph file");
+        return -1;
+    }
+    madvise((void *)data, size, MADV_SEQUENTIAL);
+    const char *end = data + size;
+
+    // Formato: DIMACS si la primera línea útil es la cabecera "p sp n m"
+    int dimacs = 0;
+    long header_nodes = -1;
+    for (const char *p = data; p < end;) {
+        const char *line_end = memchr(p, '\n', end - p);
+        if (!line_end) line_end = end;
+        const char *q = skip_blanks(p, line_end);
+        if (q < line_end && *q == 'p') {
+            q++;
+            while (q < line_end && (*q == ' ' || *q == '\t' || (*q >= 'a' && *q <= 'z'))) q++;
+            dimacs = parse_int(q, line_end, &header_nodes) != NULL;
+            break;
+        }
+        if (q < line_end && *q != 'c' && *q != '#' && *q != '%') {
+            break;
+        }
+        p = line_end + 1;
+    }
+
+    long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int num_chunks = num_cpus > 0 ? (int)num_cpus : 1;
+    if ((size_t)num_chunks > size / 4096 + 1) {
+        num_chunks = (int)(size / 4096) + 1;
+    }
+    ParseChunk chunks[num_chunks];
+    const char *p = data;
+    for (int i = 0; i < num_chunks; i++) {
+        const char *chunk_end = (i == num_chunks - 1) ? end : data + size / num_chunks * (i + 1);
+        if (chunk_end < p) chunk_end = p;
+        const char *newline = memchr(chunk_end, '\n', end - chunk_end);
+        chunk_end = newline ? newline + 1 : end;
+        chunks[i].begin = p;
+        chunks[i].end = chunk_end;
+        chunks[i].dimacs = dimacs;
+        chunks[i].out = NULL;
+        p = chunk_end;
+    }
+
+    // Primera pasada: contar aristas por trozo para saber dónde escribe cada uno
+    if (run_parse_threads(chunks, num_chunks) != 0) {
+        munmap((void *)data, size);
+        return -1;
+    }
+    long num_edges = 0;
+    int max_node = -1;
+    long bad_lines = 0;
+    for (int i = 0; i < num_chunks; i++) {
+        num_edges += chunks[i].count;
+        bad_lines += chunks[i].bad_lines;
+        if (chunks[i].max_node > max_node) max_node = chunks[i].max_node;
+    }
+    if (bad_lines > 0) {
+        fprintf(stderr, "El archivo de grafo '%s' tiene %ld líneas inválidas\n", path, bad_lines);
+        munmap((void *)data, size);
+        return -1;
+    }
+    if (num_edges == 0 || num_edges > INT_MAX) {
+        fprintf(stderr, "El archivo de grafo '%s' tiene %ld aristas\n", path, num_edges);
+        munmap((void *)data, size);
+        return -1;
+    }
+    long num_nodes = dimacs ? header_nodes : (long)max_node + 1;
+    if (num_nodes <= max_node || num_nodes >= INT_MAX) {
+        fprintf(stderr, "El archivo de grafo '%s' declara %ld nodos pero usa el nodo %d\n",
+                path, num_nodes, max_node + dimacs);
+        munmap((void *)data, size);
+        return -1;
+    }
+
+    RawEdge *raw = (RawEdge *)malloc((size_t)num_edges * sizeof(RawEdge));
+    if (!raw) {
+        perror("Error allocating memory for edges");
+        munmap((void *)data, size);
+        return -1;
+    }
+    long offset = 0;
+    for (int i = 0; i < num_chunks; i++) {
+        chunks[i].out = raw + offset;
+        offset += chunks[i].count;
+    }
+
+    // Segunda pasada: cada trozo escribe sus aristas en su propio rango
+    int status = run_parse_threads(chunks, num_chunks);
+    munmap((void *)data, size);
+    if (status == 0) {
+        status = build_graph(graph, raw, (int)num_edges, (int)num_nodes);
+    }
+    free(raw);
+    return status;
+}
+
+// Opciones de línea de comandos; las listas de N y M se usan en el barrido
+typedef struct {
+    const char *graph_path;
+    int thread_counts[16];
+    int num_thread_counts;
+    int semaphore_limits[16];
+    int num_semaphore_limits;
+    int seeded;
+    int sweep;
+    int json;
+    int pheromones;
+    int prune;
+} Options;
+
+void print_usage(const char *program) {
+    fprintf(stderr,
+            "Uso: %s [opciones] [grafo]\n"
+            "  -g, --grafo ARCHIVO     grafo en formato lista de aristas o DIMACS (.gr)\n"
+            "  -n, --threads N         cantidad de threads (si se omite se pregunta)\n"
+            "  -m, --capacidad M       límite de threads por arista (si se omite se pregunta)\n"
+            "  -s, --semilla S         semilla del generador aleatorio\n"
+            "  -k, --caminatas K       caminatas por thread (con -s el resultado es reproducible)\n"
+            "  -p, --pausa US          pausa entre caminatas en microsegundos (10000 por defecto)\n"
+            "  -t, --tiempo SEG        tiempo máximo de búsqueda (60 por defecto, 0 = sin límite)\n"
+            "  -w, --sin-mejora SEG    detener si no hay mejoras durante SEG segundos\n"
+            "  -c, --objetivo COSTO    detener al encontrar una ruta de costo <= COSTO\n"
+            "  -b, --cota              detener al alcanzar el costo mínimo exacto (Dijkstra)\n"
+            "  -i, --telemetria SEG    imprimir telemetría cada SEG segundos\n"
+            "  -x, --barrido           ejecutar todas las combinaciones de -n y -m (listas\n"
+            "                          separadas por coma) y emitir resultados en CSV\n"
+            "  -j, --json              emitir el barrido en JSON en vez de CSV\n"
+            "  -f, --feromonas         sesgar las caminatas con una tabla de feromonas; en el\n"
+            "                          barrido se compara contra caminatas uniformes\n"
+            "  -e, --evaporacion R     fracción de feromona evaporada cada %.2f s, o cada %d\n"
+            "                          caminatas con -s (0.1)\n"
+            "  -P, --sin-poda          no abandonar caminatas que ya no pueden mejorar ni\n"
+            "                          eliminar callejones sin salida\n",
+            program, EVAPORATION_PERIOD, EVAPORATION_WALKS);
+}
 
+// Lee una lista "a,b,c" de enteros positivos
+int parse_int_list(const char *text, int *values, int max_values) {
+    int count = 0;
+    char *end;
     do {
-        printf("Ingrese el valor M correspondiente al límite de threads por arista (2 o 3): ");
-        scanf("%d", &semaphore_limit);
-    } while (semaphore_limit != 2 && semaphore_limit != 3);
-
-    Edge edges[] = {
-        {0, 1, 1, {0}},
-        {0, 2, 2, {0}},
-        {1, 3, 3, {0}},
-        {1, 4, 1, {0}},
-        {2, 4, 2, {0}},
-        {2, 5, 3, {0}},
-        {3, 6, 1, {0}},
-        {3, 7, 2, {0}},
-        {4, 7, 3, {0}},
-        {4, 8, 1, {0}},
-        {5, 8, 2, {0}},
-        {5, 9, 3, {0}},
-        {6, 10, 1, {0}},
-        {7, 10, 2, {0}},
-        {7, 11, 3, {0}},
-        {8, 11, 1, {0}},
-        {8, 12, 2, {0}},
-        {9, 12, 3, {0}},
-        {9, 13, 1, {0}},
-        {10, 14, 2, {0}},
-        {11, 14, 3, {0}},
-        {11, 15, 1, {0}},
-        {12, 15, 2, {0}},
-        {12, 16, 3, {0}},
-        {13, 16, 1, {0}},
-        {13, 17, 2, {0}},
-        {14, 18, 3, {0}},
-        {15, 18, 1, {0}},
-        {16, 18, 2, {0}},
-        {18, 19, 3, {0}}
+        long value = strtol(text, &end, 10);
+        if (end == text || value <= 0 || value > INT_MAX || count == max_values) {
+            return -1;
+        }
+        values[count++] = (int)value;
+        text = end + 1;
+    } while (*end == ',');
+    return *end == '\0' ? count : -1;
+}
+
+int parse_options(int argc, char *argv[], Options *opts) {
+    static const struct option options[] = {
+        {"grafo", required_argument, NULL, 'g'},
+        {"threads", required_argument, NULL, 'n'},
+        {"capacidad", required_argument, NULL, 'm'},
+        {"semilla", required_argument, NULL, 's'},
+        {"caminatas", required_argument, NULL, 'k'},
+        {"pausa", required_argument, NULL, 'p'},
+        {"tiempo", required_argument, NULL, 't'},
+        {"sin-mejora", required_argument, NULL, 'w'},
+        {"objetivo", required_argument, NULL, 'c'},
+        {"cota", no_argument, NULL, 'b'},
+        {"telemetria", required_argument, NULL, 'i'},
+        {"barrido", no_argument, NULL, 'x'},
+        {"json", no_argument, NULL, 'j'},
+        {"feromonas", no_argument, NULL, 'f'},
+        {"evaporacion", required_argument, NULL, 'e'},
+        {"sin-poda", no_argument, NULL, 'P'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}
     };
+    int time_given = 0;
+    int option;
+    while ((option = getopt_long(argc, argv, "g:n:m:s:k:p:t:w:c:bi:xjfe:Ph", options, NULL)) != -1) {
+        switch (option) {
+            case 'g': opts->graph_path = optarg; break;
+            case 'n':
+                opts->num_thread_counts = parse_int_list(optarg, opts->thread_counts, 16);
+                if (opts->num_thread_counts < 0) {
+                    fprintf(stderr, "Valor inválido para -n: %s\n", optarg);
+                    return -1;
+                }
+                break;
+            case 'm':
+                opts->num_semaphore_limits = parse_int_list(optarg, opts->semaphore_limits, 16);
+                if (opts->num_semaphore_limits < 0) {
+                    fprintf(stderr, "Valor inválido para -m: %s\n", optarg);
+                    return -1;
+                }
+                break;
+            case 's':
+                search_seed = strtoull(optarg, NULL, 10);
+                opts->seeded = 1;
+                deterministic = 1;
+                break;
+            case 'k': walk_budget = strtoul(optarg, NULL, 10); break;
+            case 'p': walk_pause = (useconds_t)strtoul(optarg, NULL, 10); break;
+            case 't':
+                stop_conditions.time_budget = atof(optarg);
+                time_given = 1;
+                break;
+            case 'w': stop_conditions.stall_window = atof(optarg); break;
+            case 'c': stop_conditions.target_cost = atoi(optarg); break;
+            case 'b': stop_conditions.stop_at_lower_bound = 1; break;
+            case 'i': stop_conditions.report_interval = atof(optarg); break;
+            case 'x': opts->sweep = 1; break;
+            case 'j': opts->json = 1; break;
+            case 'f': opts->pheromones = 1; break;
+            case 'e': evaporation_rate = atof(optarg); break;
+            case 'P': opts->prune = 0; break;
+            default:
+                print_usage(argv[0]);
+                return -1;
+        }
+    }
+    if (optind < argc) {
+        opts->graph_path = argv[optind++];
+    }
+    if (optind < argc || stop_conditions.time_budget < 0 || stop_conditions.stall_window < 0 ||
+        stop_conditions.report_interval < 0 || evaporation_rate < 0 || evaporation_rate >= 1) {
+        print_usage(argv[0]);
+        return -1;
+    }
+    // Con un número fijo de caminatas el tiempo deja de ser el límite por defecto
+    if (walk_budget > 0 && !time_given) {
+        stop_conditions.time_budget = 0;
+    }
+    if (stop_conditions.time_budget == 0 && stop_conditions.stall_window == 0 &&
+        stop_conditions.target_cost < 0 && !stop_conditions.stop_at_lower_bound && walk_budget == 0) {
+        fprintf(stderr, "Se necesita al menos una condición de término\n");
+        return -1;
+    }
+    if (!opts->sweep && (opts->num_thread_counts > 1 || opts->num_semaphore_limits > 1)) {
+        fprintf(stderr, "Las listas de valores para -n y -m sólo se aceptan con --barrido\n");
+        return -1;
+    }
+    return 0;
+}
 
-    int num_edges = sizeof(edges) / sizeof(edges[0]);
+// Deja el estado global listo para una nueva ejecución de la búsqueda
+void reset_search_state(void) {
+    atomic_store(&global_min_cost, INT_MAX);
+    atomic_store(&stop_threads, 0);
+    atomic_store(&finished_threads, 0);
+    global_min_route_length = 0;
+    thread_with_min_cost = -1;
+    walk_with_min_cost = 0;
+    stop_reason = "";
+    last_improvement_time = 0;
+    cost_history_length = 0;
+}
 
-    Graph route;
-    route.numNodes = NUM_NODES;
-    route.numEdges = num_edges;
-    route.edges = edges;
+// Ejecuta una búsqueda completa con N threads y M threads por arista
+int run_search(Graph *graph, int num_threads, int semaphore_limit, Threads *threadInfos,
+               SearchResult *result) {
+    reset_search_state();
 
-    for (int i = 0; i < num_edges; i++) {
-        if (sem_init(&(route.edges[i].semaphore), 0, semaphore_limit) != 0) {
+    for (int i = 0; i < graph->numEdges; i++) {
+        if (sem_init(&(graph->edges[i].semaphore), 0, semaphore_limit) != 0) {
             perror("Error in semaphore initialization");
-            return 1;
+            return -1;
         }
     }
 
-    if (pthread_mutex_init(&min_cost_mutex, NULL) != 0) {
-        perror("Error in mutex initialization");
-        return 1;
+    if (use_pheromones) {
+        for (int i = 0; i < graph->numEdges; i++) {
+            atomic_init(&pheromones[i], PHEROMONE_ONE);
+        }
+        atomic_store(&evaporation_walks, 0);
     }
 
     pthread_t threads[num_threads];
-    Threads threadInfos[num_threads];
-
-    start_time = time(NULL);
-    printf("El programa se ejecutará por 60 segundos, utilizando %d threads en total y %d threads máximo por semáforo en cada Arista de los nodos",num_threads,semaphore_limit);
-    printf("\n");
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
     for (int i = 0; i < num_threads; i++) {
         threadInfos[i].id = i + 1;
-        threadInfos[i].graph = &route;
+        threadInfos[i].graph = graph;
+        atomic_init(&threadInfos[i].walks, 0);
+        atomic_init(&threadInfos[i].arrivals, 0);
+        atomic_init(&threadInfos[i].pruned, 0);
+        atomic_init(&threadInfos[i].improvements, 0);
         if (pthread_create(&threads[i], NULL, find_route, (void *)&threadInfos[i]) != 0) {
             perror("Error in thread creation");
-            return 1;
+            return -1;
         }
     }
 
+    monitor_search(graph, threadInfos, num_threads);
+    double elapsed = elapsed_seconds();
+
     for (int i = 0; i < num_threads; i++) {
         if (pthread_join(threads[i], NULL) != 0) {
             perror("Error in thread join");
-            return 1;
+            return -1;
         }
     }
 
-    for (int i = 0; i < num_edges; i++) {
-        if (sem_destroy(&(route.edges[i].semaphore)) != 0) {
+    for (int i = 0; i < graph->numEdges; i++) {
+        if (sem_destroy(&(graph->edges[i].semaphore)) != 0) {
             perror("Error in semaphore destruction");
+            return -1;
+        }
+    }
+
+    result->num_threads = num_threads;
+    result->semaphore_limit = semaphore_limit;
+    result->pheromones = use_pheromones;
+    result->seconds = elapsed;
+    result->walks = 0;
+    result->pruned = 0;
+    for (int i = 0; i < num_threads; i++) {
+        result->walks += atomic_load(&threadInfos[i].walks);
+        result->pruned += atomic_load(&threadInfos[i].pruned);
+    }
+    result->best_cost = atomic_load(&global_min_cost);
+    return 0;
+}
+
+// Una fila por punto de la evolución del mejor costo, con el resumen repetido
+void emit_sweep_csv(const SearchResult *result) {
+    int rows = cost_history_length > 0 ? cost_history_length : 1;
+    for (int i = 0; i < rows; i++) {
+        printf("%d,%d,%s,%.3f,%lu,%.1f,%lu,", result->num_threads, result->semaphore_limit,
+               result->pheromones ? "feromonas" : "uniforme", result->seconds,
+               result->walks, result->seconds > 0 ? result->walks / result->seconds : 0.0, result->pruned);
+        if (result->best_cost != INT_MAX) {
+            printf("%d", result->best_cost);
+        }
+        if (cost_history_length > 0) {
+            printf(",%.6f,%d\n", cost_history[i].seconds, cost_history[i].cost);
+        } else {
+            printf(",,\n");
+        }
+    }
+}
+
+void emit_sweep_json(const SearchResult *result, int first) {
+    printf("%s\n  {\"n\": %d, \"m\": %d, \"estrategia\": \"%s\", \"segundos\": %.3f, \"caminatas\": %lu, "
+           "\"caminatas_por_s\": %.1f, \"podadas\": %lu, \"mejor_costo\": ",
+           first ? "" : ",", result->num_threads, result->semaphore_limit,
+           result->pheromones ? "feromonas" : "uniforme", result->seconds, result->walks,
+           result->seconds > 0 ? result->walks / result->seconds : 0.0, result->pruned);
+    if (result->best_cost == INT_MAX) {
+        printf("null");
+    } else {
+        printf("%d", result->best_cost);
+    }
+    printf(", \"historial\": [");
+    for (int i = 0; i < cost_history_length; i++) {
+        printf("%s{\"t\": %.6f, \"costo\": %d}", i ? ", " : "", cost_history[i].seconds, cost_history[i].cost);
+    }
+    printf("]}");
+}
+
+// Barrido sobre todas las combinaciones (N, M). El resultado va a stdout y
+// los mensajes de avance a stderr.
+int run_sweep(Graph *graph, const Options *opts) {
+    if (opts->json) {
+        printf("[");
+    } else {
+        printf("n,m,estrategia,segundos,caminatas,caminatas_por_s,podadas,mejor_costo,t,costo\n");
+    }
+    int first = 1;
+    for (int a = 0; a < opts->num_thread_counts; a++) {
+        int num_threads = opts->thread_counts[a];
+        Threads *threadInfos = (Threads *)aligned_alloc(64, num_threads * sizeof(Threads));
+        if (!threadInfos) {
+            perror("Error allocating memory for threads");
+            return -1;
+        }
+        for (int b = 0; b < opts->num_semaphore_limits; b++) {
+            for (int strategy = 0; strategy <= opts->pheromones; strategy++) {
+                SearchResult result;
+                use_pheromones = strategy;
+                fprintf(log_stream, "Barrido: N=%d M=%d %s\n", num_threads, opts->semaphore_limits[b],
+                        strategy ? "feromonas" : "uniforme");
+                if (run_search(graph, num_threads, opts->semaphore_limits[b], threadInfos, &result) != 0) {
+                    free(threadInfos);
+                    return -1;
+                }
+                if (opts->json) {
+                    emit_sweep_json(&result, first);
+                } else {
+                    emit_sweep_csv(&result);
+                }
+                first = 0;
+                fflush(stdout);
+            }
+        }
+        free(threadInfos);
+    }
+    if (opts->json) {
+        printf("\n]\n");
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    Options opts = {0};
+    opts.prune = 1;
+    log_stream = stdout;
+
+    if (parse_options(argc, argv, &opts) != 0) {
+        return 1;
+    }
+    if (!opts.seeded) {
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        search_seed = splitmix64((uint64_t)now.tv_sec ^ ((uint64_t)now.tv_nsec << 20) ^ (uint64_t)getpid());
+    }
+    if (opts.sweep) {
+        verbose = 0;
+        log_stream = stderr;
+        if (opts.num_thread_counts == 0) {
+            opts.num_thread_counts = 3;
+            memcpy(opts.thread_counts, (int[]){5, 10, 20}, sizeof(int) * 3);
+        }
+        if (opts.num_semaphore_limits == 0) {
+            opts.num_semaphore_limits = 2;
+            memcpy(opts.semaphore_limits, (int[]){2, 3}, sizeof(int) * 2);
+        }
+    }
+
+    Graph route;
+    if (opts.graph_path) {
+        if (load_graph(opts.graph_path, &route) != 0) {
+            return 1;
+        }
+        fprintf(log_stream, "Grafo '%s' cargado: %d nodos y %d aristas\n", opts.graph_path, route.numNodes,
+                route.numEdges);
+    } else {
+        int num_edges = sizeof(default_edges) / sizeof(default_edges[0]);
+        if (build_graph(&route, default_edges, num_edges, 20) != 0) {
+            return 1;
+        }
+    }
+
+    if (opts.prune || stop_conditions.stop_at_lower_bound) {
+        int *distances = compute_distances_to_finish(&route);
+        if (!distances) {
+            return 1;
+        }
+        if (distances[0] == INT_MAX) {
+            fprintf(log_stream, "No existe una ruta entre el nodo 0 y el nodo %d\n", route.numNodes - 1);
+            free(distances);
+            free_graph(&route);
+            return 0;
+        }
+        if (stop_conditions.stop_at_lower_bound) {
+            lower_bound = distances[0];
+            fprintf(log_stream, "Cota inferior exacta del costo: %d\n", lower_bound);
+        }
+        if (opts.prune) {
+            int removed = prune_dead_ends(&route, distances);
+            fprintf(log_stream, "Poda: %d aristas hacia callejones sin salida eliminadas\n", removed);
+            distance_to_finish = distances;
+        } else {
+            free(distances);
+        }
+    }
+
+    global_min_route = (int *)malloc(route.numNodes * sizeof(int));
+    if (!global_min_route) {
+        perror("Error allocating memory for route");
+        return 1;
+    }
+
+    if (pthread_mutex_init(&min_cost_mutex, NULL) != 0) {
+        perror("Error in mutex initialization");
+        return 1;
+    }
+
+    if (opts.pheromones) {
+        pheromones = (atomic_uint *)malloc((size_t)route.numEdges * sizeof(atomic_uint));
+        if (!pheromones) {
+            perror("Error allocating memory for pheromones");
+            return 1;
+        }
+        use_pheromones = 1;
+    }
+
+    if (opts.sweep) {
+        int status = run_sweep(&route, &opts);
+        pthread_mutex_destroy(&min_cost_mutex);
+        free(pheromones);
+        free(distance_to_finish);
+        free(cost_history);
+        free(global_min_route);
+        free_graph(&route);
+        return status == 0 ? 0 : 1;
+    }
+
+    int num_threads = opts.num_thread_counts ? opts.thread_counts[0] : 0;
+    int semaphore_limit = opts.num_semaphore_limits ? opts.semaphore_limits[0] : 0;
+
+    while (num_threads != 5 && num_threads != 10 && num_threads != 20 && !opts.num_thread_counts) {
+        printf("Ingrese el valor N correspondiente a la cantidad de Threads (5, 10, o 20): ");
+        if (scanf("%d", &num_threads) != 1) {
             return 1;
         }
     }
 
+    while (semaphore_limit != 2 && semaphore_limit != 3 && !opts.num_semaphore_limits) {
+        printf("Ingrese el valor M correspondiente al límite de threads por arista (2 o 3): ");
+        if (scanf("%d", &semaphore_limit) != 1) {
+            return 1;
+        }
+    }
+
+    Threads *threadInfos = (Threads *)aligned_alloc(64, num_threads * sizeof(Threads));
+    if (!threadInfos) {
+        perror("Error allocating memory for threads");
+        return 1;
+    }
+
+    if (stop_conditions.time_budget > 0) {
+        printf("El programa se ejecutará por un máximo de %g segundos", stop_conditions.time_budget);
+    } else {
+        printf("El programa se ejecutará hasta cumplir una condición de término");
+    }
+    printf(", utilizando %d threads en total y %d threads máximo por semáforo en cada Arista de los nodos",num_threads,semaphore_limit);
+    if (use_pheromones) {
+        printf(", con caminatas sesgadas por feromonas");
+    }
+    printf("\n");
+
+    SearchResult result;
+    if (run_search(&route, num_threads, semaphore_limit, threadInfos, &result) != 0) {
+        return 1;
+    }
+
     if (pthread_mutex_destroy(&min_cost_mutex) != 0) {
         perror("Error in mutex destruction");
         return 1;
     }
-    printf("El tiempo ha finalizado");
+    printf("La búsqueda terminó a los %.2f segundos porque %s", result.seconds, stop_reason);
     printf("\n");
-    printf("El Thread %d encontró la ruta [", thread_with_min_cost);
-    for (int i = 0; i < global_min_route_length; i++) {
-        printf("%d%s", global_min_route[i], i < global_min_route_length - 1 ? " " : " ");
+
+    printf("Caminatas completas: %lu (%.0f por segundo), %lu cortadas por la poda\n", result.walks,
+           result.seconds > 0 ? result.walks / result.seconds : 0.0, result.pruned);
+    for (int i = 0; i < num_threads; i++) {
+        printf("  Thread %d: %lu caminatas completas, %lu llegaron al final, %lu podadas, %lu mejoras\n",
+               threadInfos[i].id,
+               atomic_load(&threadInfos[i].walks), atomic_load(&threadInfos[i].arrivals),
+               atomic_load(&threadInfos[i].pruned), atomic_load(&threadInfos[i].improvements));
+    }
+    printf("Evolución del mejor costo:\n");
+    for (int i = 0; i < cost_history_length; i++) {
+        printf("  %8.3f s  costo %d  (Thread %d)\n", cost_history[i].seconds, cost_history[i].cost,
+               cost_history[i].thread);
     }
+
+    if (global_min_route_length == 0) {
+        printf("Ningún thread encontró una ruta hasta el nodo %d.\n", route.numNodes - 1);
+    } else {
+        printf("El Thread %d encontró la ruta [", thread_with_min_cost);
+        print_route(global_min_route, global_min_route_length);
         printf("], ");
 
-    printf("que corresponde a la ruta con menor costo, con un valor de %d.\n", global_min_cost);
+        printf("que corresponde a la ruta con menor costo, con un valor de %d.\n", result.best_cost);
+    }
 
+    free(threadInfos);
+    free(pheromones);
+    free(distance_to_finish);
+    free(cost_history);
+    free(global_min_route);
+    free_graph(&route);
     return 0;
 }
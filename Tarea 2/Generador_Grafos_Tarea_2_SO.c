@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+// Generador de grafos sintéticos para Codigo_Tarea_2_SO.c
+//
+//   grid   <ancho> <alto>     <archivo> [semilla]
+//   random <nodos> <aristas>  <archivo> [semilla]
+//
+// Igual que el grafo original, todas las aristas van de un nodo a otro de
+// número mayor, así que cualquier caminata desde el nodo 0 termina en el
+// último nodo. Si el archivo termina en ".gr" se escribe en formato DIMACS
+// (nodos desde 1), si no como lista de aristas "u v costo" (nodos desde 0).
+
+#define MAX_EDGE_COST 9
+
+static uint64_t rng_state;
+
+static uint64_t next_random(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static long random_below(long limit) {
+    return (long)(next_random() % (uint64_t)limit);
+}
+
+static int dimacs;
+
+static void write_header(FILE *out, long num_nodes, long num_edges) {
+    if (dimacs) {
+        fprintf(out, "c generado por Generador_Grafos_Tarea_2_SO\n");
+        fprintf(out, "p sp %ld %ld\n", num_nodes, num_edges);
+    } else {
+        fprintf(out, "# %ld nodos, %ld aristas\n", num_nodes, num_edges);
+    }
+}
+
+static void write_edge(FILE *out, long source, long destination) {
+    long cost = 1 + random_below(MAX_EDGE_COST);
+    if (dimacs) {
+        fprintf(out, "a %ld %ld %ld\n", source + 1, destination + 1, cost);
+    } else {
+        fprintf(out, "%ld %ld %ld\n", source, destination, cost);
+    }
+}
+
+// Grilla de ancho x alto con aristas hacia la derecha y hacia abajo
+static void generate_grid(FILE *out, long width, long height) {
+    long num_edges = (width - 1) * height + width * (height - 1);
+    write_header(out, width * height, num_edges);
+    for (long row = 0; row < height; row++) {
+        for (long col = 0; col < width; col++) {
+            long node = row * width + col;
+            if (col + 1 < width) write_edge(out, node, node + 1);
+            if (row + 1 < height) write_edge(out, node, node + width);
+        }
+    }
+}
+
+// Cada nodo recibe una arista hacia un nodo mayor (así no hay callejones sin
+// salida) y el resto de las aristas se reparte al azar
+static void generate_random(FILE *out, long num_nodes, long num_edges) {
+    write_header(out, num_nodes, num_edges);
+    for (long node = 0; node < num_nodes - 1; node++) {
+        write_edge(out, node, node + 1 + random_below(num_nodes - 1 - node));
+    }
+    for (long i = num_nodes - 1; i < num_edges; i++) {
+        long source = random_below(num_nodes - 1);
+        write_edge(out, source, source + 1 + random_below(num_nodes - 1 - source));
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 5 || argc > 6 || (strcmp(argv[1], "grid") != 0 && strcmp(argv[1], "random") != 0)) {
+        fprintf(stderr, "Uso: %s grid <ancho> <alto> <archivo> [semilla]\n", argv[0]);
+        fprintf(stderr, "     %s random <nodos> <aristas> <archivo> [semilla]\n", argv[0]);
+        return 1;
+    }
+
+    long first = atol(argv[2]);
+    long second = atol(argv[3]);
+    const char *path = argv[4];
+    rng_state = argc == 6 ? strtoull(argv[5], NULL, 10) : 88172645463325252ULL;
+    if (rng_state == 0) {
+        rng_state = 88172645463325252ULL;
+    }
+    size_t length = strlen(path);
+    dimacs = length > 3 && strcmp(path + length - 3, ".gr") == 0;
+
+    int grid = strcmp(argv[1], "grid") == 0;
+    if (grid ? (first < 1 || second < 1 || first * second < 2)
+             : (first < 2 || second < first - 1)) {
+        fprintf(stderr, "Parámetros inválidos para el grafo %s\n", argv[1]);
+        return 1;
+    }
+    if (grid ? first * second >= 2147483647L : first >= 2147483647L || second >= 2147483647L) {
+        fprintf(stderr, "El grafo es demasiado grande\n");
+        return 1;
+    }
+
+    FILE *out = fopen(path, "w");
+    if (!out) {
+        perror("Error opening output file");
+        return 1;
+    }
+    static char buffer[1 << 20];
+    setvbuf(out, buffer, _IOFBF, sizeof(buffer));
+
+    if (grid) {
+        generate_grid(out, first, second);
+    } else {
+        generate_random(out, first, second);
+    }
+
+    if (fclose(out) != 0) {
+        perror("Error writing output file");
+        return 1;
+    }
+    return 0;
+}
@@ -4,6 +4,14 @@
 #include <vector>
 #include <iterator>
 #include <map>
+#include <memory>
+#include <deque>
+#include <set>
+#include <fnmatch.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
 #include <string>
 #include <filesystem>
 #include <fstream>
@@ -17,34 +25,351 @@
 using namespace std;
 namespace fs = std::filesystem;
 
+// Ordered map whose versions share structure. It's a treap of immutable
+// nodes: inserting or erasing copies only the O(log n) nodes on the way to
+// the key, and copying the map copies one pointer. Directories keep their
+// children in one so that copying a directory on the path of a change
+// doesn't copy its entries.
+template <typename Key, typename Value, typename Compare = less<Key>>
+class PersistentMap {
+    struct Node;
+    using Link = shared_ptr<const Node>;
+
+    struct Node {
+        pair<Key, Value> item;
+        uint32_t priority;
+        Link left, right;
+    };
+
+public:
+    // Walks the entries in order, keeping the nodes still to visit on a stack
+    class const_iterator {
+    public:
+        const pair<Key, Value>& operator*() const { return stack.back()->item; }
+        const pair<Key, Value>* operator->() const { return &stack.back()->item; }
+        bool operator==(const const_iterator& other) const {
+            return stack.empty() ? other.stack.empty() : !other.stack.empty() && stack.back() == other.stack.back();
+        }
+        bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+        const_iterator& operator++() {
+            const Node* node = stack.back()->right.get();
+            stack.pop_back();
+            pushLeft(node);
+            return *this;
+        }
+
+    private:
+        friend class PersistentMap;
+        vector<const Node*> stack;
+
+        void pushLeft(const Node* node) {
+            for (; node; node = node->left.get()) {
+                stack.push_back(node);
+            }
+        }
+    };
+
+    size_t size() const { return entries; }
+    bool empty() const { return entries == 0; }
+
+    const_iterator begin() const {
+        const_iterator it;
+        it.pushLeft(root.get());
+        return it;
+    }
+
+    const_iterator end() const { return const_iterator(); }
+
+    const_iterator find(const Key& key) const {
+        const_iterator it;
+        for (const Node* node = root.get(); node;) {
+            if (compare(key, node->item.first)) {
+                it.stack.push_back(node);
+                node = node->left.get();
+            } else if (compare(node->item.first, key)) {
+                node = node->right.get();
+            } else {
+                it.stack.push_back(node);
+                return it;
+            }
+        }
+        return end();
+    }
+
+    // First entry after key
+    const_iterator upper_bound(const Key& key) const {
+        const_iterator it;
+        for (const Node* node = root.get(); node;) {
+            if (compare(key, node->item.first)) {
+                it.stack.push_back(node);
+                node = node->left.get();
+            } else {
+                node = node->right.get();
+            }
+        }
+        return it;
+    }
+
+    size_t count(const Key& key) const { return find(key) != end(); }
+
+    const Value& at(const Key& key) const {
+        auto it = find(key);
+        if (it == end()) {
+            throw out_of_range("PersistentMap::at");
+        }
+        return it->second;
+    }
+
+    // Builds the map from entries sorted by key in O(n), as the treap that
+    // inserting them one by one would give, without the path copies
+    static PersistentMap fromSorted(const vector<pair<Key, Value>>& items) {
+        PersistentMap map;
+        vector<shared_ptr<Node>> rightSpine;
+        for (const auto& item : items) {
+            auto node = make_shared<Node>(Node{item, nextPriority(), nullptr, nullptr});
+            shared_ptr<Node> below;
+            while (!rightSpine.empty() && rightSpine.back()->priority < node->priority) {
+                below = rightSpine.back();
+                rightSpine.pop_back();
+            }
+            node->left = below;
+            if (!rightSpine.empty()) {
+                rightSpine.back()->right = node;
+            }
+            rightSpine.push_back(node);
+        }
+        if (!rightSpine.empty()) {
+            map.root = rightSpine.front();
+        }
+        map.entries = items.size();
+        return map;
+    }
+
+    void insert_or_assign(const Key& key, const Value& value) {
+        bool added = false;
+        root = insert(root, key, value, added);
+        entries += added;
+    }
+
+    size_t erase(const Key& key) {
+        bool removed = false;
+        root = erase(root, key, removed);
+        entries -= removed;
+        return removed;
+    }
+
+private:
+    Link root;
+    size_t entries = 0;
+    Compare compare;
+
+    static uint32_t nextPriority() {
+        static uint64_t state = 0x9e3779b97f4a7c15ULL;
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return static_cast<uint32_t>(state >> 32);
+    }
+
+    static Link make(const pair<Key, Value>& item, uint32_t priority, Link left, Link right) {
+        return make_shared<const Node>(Node{item, priority, move(left), move(right)});
+    }
+
+    Link insert(const Link& node, const Key& key, const Value& value, bool& added) {
+        if (!node) {
+            added = true;
+            return make({key, value}, nextPriority(), nullptr, nullptr);
+        }
+        if (compare(key, node->item.first)) {
+            Link left = insert(node->left, key, value, added);
+            if (left->priority > node->priority) {
+                return make(left->item, left->priority, left->left,
+                            make(node->item, node->priority, left->right, node->right));
+            }
+            return make(node->item, node->priority, left, node->right);
+        }
+        if (compare(node->item.first, key)) {
+            Link right = insert(node->right, key, value, added);
+            if (right->priority > node->priority) {
+                return make(right->item, right->priority,
+                            make(node->item, node->priority, node->left, right->left), right->right);
+            }
+            return make(node->item, node->priority, node->left, right);
+        }
+        return make({key, value}, node->priority, node->left, node->right);
+    }
+
+    Link erase(const Link& node, const Key& key, bool& removed) {
+        if (!node) {
+            return node;
+        }
+        if (compare(key, node->item.first)) {
+            Link left = erase(node->left, key, removed);
+            return removed ? make(node->item, node->priority, left, node->right) : node;
+        }
+        if (compare(node->item.first, key)) {
+            Link right = erase(node->right, key, removed);
+            return removed ? make(node->item, node->priority, node->left, right) : node;
+        }
+        removed = true;
+        return merge(node->left, node->right);
+    }
+
+    static Link merge(const Link& left, const Link& right) {
+        if (!left || !right) {
+            return left ? left : right;
+        }
+        if (left->priority > right->priority) {
+            return make(left->item, left->priority, left->left, merge(left->right, right));
+        }
+        return make(right->item, right->priority, merge(left, right->left), right->right);
+    }
+};
+
+// Inodes are persistent: once a node is shared with a snapshot or the undo
+// history it is never modified again. Changes copy the nodes on the path from
+// the root down to the changed one and share every other subtree, so a
+// snapshot is just another pointer to a root. Copying a directory copies its
+// children map in O(1) and updating the copy costs O(log n), so a change
+// costs O(depth * log width) however many entries the directories hold.
+// Nodes don't know their parent for the same reason; the current directory is
+// kept as a path instead.
+// One version of a file's data. While the file is off the disk the data waits
+// in the store, at `stored`. Every version of the tree that has the file
+// holds a reference, so once the last one is gone (dropped from the undo
+// history, no snapshot left) nothing can bring the data back and the stored
+// copy is deleted.
+struct Contents {
+    string stored; // Not an fs::path, which would also keep its parsed components
+
+    ~Contents() {
+        ::unlink(stored.c_str());
+    }
+};
+
+// Orders ls --sort size: largest first, then by name
+struct LargerFirst {
+    bool operator()(const pair<uintmax_t, string>& a, const pair<uintmax_t, string>& b) const {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    }
+};
+
 struct Inode {
     string name;
     bool isDirectory;
     string permissions;
-    Inode* parent;
-    map<string, Inode*> children;
+    PersistentMap<string, shared_ptr<Inode>> children;
+    // Secondary indexes for ls --sort time and --sort size, kept up to date
+    // on every change to the children and shared between versions like them
+    PersistentMap<pair<std::time_t, string>, bool> childrenByTime;
+    PersistentMap<pair<uintmax_t, string>, bool, LargerFirst> childrenBySize;
     std::time_t creationTime;
+    int ino; // Shared by every version of the same file or directory
+    shared_ptr<const Contents> contents; // A file's data
+    uintmax_t size = 0; // Bytes of a file, kept so ls-l and du don't stat
+    unsigned epoch = 0; // Tree version the node was copied for, see mutableNode
 
-    Inode(string n, bool isDir, string perms, Inode* p)
-        : name(n), isDirectory(isDir), permissions(perms), parent(p) {
+    Inode(string n, bool isDir, string perms, int number)
+        : name(n), isDirectory(isDir), permissions(perms), ino(number) {
         creationTime = std::time(nullptr);
     }
+
+    void addChild(const shared_ptr<Inode>& child) {
+        removeChild(child->name);
+        children.insert_or_assign(child->name, child);
+        childrenByTime.insert_or_assign({child->creationTime, child->name}, true);
+        childrenBySize.insert_or_assign({child->size, child->name}, true);
+    }
+
+    // Replaces every child at once, in O(n) after sorting
+    void setChildren(vector<shared_ptr<Inode>> nodes) {
+        vector<pair<string, shared_ptr<Inode>>> byName;
+        vector<pair<pair<std::time_t, string>, bool>> byTime;
+        vector<pair<pair<uintmax_t, string>, bool>> bySize;
+        for (const auto& node : nodes) {
+            byName.push_back({node->name, node});
+            byTime.push_back({{node->creationTime, node->name}, true});
+            bySize.push_back({{node->size, node->name}, true});
+        }
+        sort(byName.begin(), byName.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        sort(byTime.begin(), byTime.end());
+        sort(bySize.begin(), bySize.end(), [](const auto& a, const auto& b) { return LargerFirst()(a.first, b.first); });
+        children = decltype(children)::fromSorted(byName);
+        childrenByTime = decltype(childrenByTime)::fromSorted(byTime);
+        childrenBySize = decltype(childrenBySize)::fromSorted(bySize);
+    }
+
+    void removeChild(const string& childName) {
+        auto child = children.find(childName);
+        if (child != children.end()) {
+            childrenByTime.erase({child->second->creationTime, childName});
+            childrenBySize.erase({child->second->size, childName});
+            children.erase(childName);
+        }
+    }
+
+    // Moves a child whose size was oldSize to its new place in the size index
+    void childResized(const string& childName, uintmax_t oldSize) {
+        childrenBySize.erase({oldSize, childName});
+        childrenBySize.insert_or_assign({children.at(childName)->size, childName}, true);
+    }
+};
+
+using InodePtr = shared_ptr<Inode>;
+
+// One difference between two versions of the tree. Paths are relative to
+// the root ("/a/b") and refer to the tree after the earlier changes of the
+// same list, so applying them in order turns one version into the other.
+struct Change {
+    enum Kind { Removed, Renamed, Added, Modified } kind;
+    string path;
+    string newPath; // Renamed only
+    InodePtr before;
+    InodePtr after;
+};
+
+// Options of ls, ls-l and ls-li. Entries are filtered while the directory is
+// walked and the walk stops once limit entries are printed, so without
+// filters a page costs the same however large the directory is. A selective
+// --type or --name filter may still walk the whole directory to fill a page.
+struct ListOptions {
+    size_t limit = 0;  // 0 prints every entry
+    string after;      // Start after this entry, the cursor of the previous page
+    char type = 0;     // 'f' or 'd' to show only files or directories
+    string pattern;    // Glob the name must match
+    enum Order { ByName, ByTime, BySize } order = ByName;
+};
+
+enum ListFormat { NamesOnly, LongFormat, LongFormatWithInode };
+
+struct Snapshot {
+    InodePtr root;
+    std::time_t time;
 };
 
 class FileSystem {
 public:
     FileSystem() {
-        root = new Inode("/", true, "drwxrwxrwx", nullptr);
-        currentDirectory = root;
+        root = make_shared<Inode>("/", true, "drwxrwxrwx", nextIno++);
         rootPath = fs::current_path() / "root";
         if (!fs::exists(rootPath)) {
             fs::create_directory(rootPath);
         }
-        mapFileSystem(rootPath, root);
+        // Only this session's snapshots and history can refer to the store,
+        // so each session gets a new one
+        string store = (rootPath.parent_path() / ".root_store.XXXXXX").string();
+        if (!mkdtemp(store.data())) {
+            cout << "Error: Failed to create the store directory '" << store << "'." << endl;
+            exit(EXIT_FAILURE);
+        }
+        storePath = store;
+        mapFileSystem(rootPath, root.get());
     }
 
     ~FileSystem() {
-        deleteInode(root);
+        std::error_code error;
+        fs::remove_all(storePath, error);
     }
 
     void touch(string name) {
@@ -56,8 +381,10 @@ public:
             if (fd != -1) {
                 close(fd);
 
-                Inode* file = new Inode(name, false, "-rw-r--r--", currentDirectory);
-                currentDirectory->children[name] = file;
+                checkpoint();
+                auto file = make_shared<Inode>(name, false, "-rw-r--r--", nextIno++);
+                file->contents = newContents();
+                mutableNode(cwd)->addChild(file);
             } else {
                 cout << "Error: Failed to create file '" << name << "'." << endl;
             }
@@ -69,6 +396,7 @@ public:
     void mkdir(string name) {
         fs::path dirPath = currentPath() / name;
         if (!fs::exists(dirPath)) {
+            Inode* currentDirectory = resolve(cwd);
             if (currentDirectory->permissions[2] != 'w') {
                 cout << "Error: No write permission in the current directory '" << currentDirectory->name << "'." << endl;
                 return;
@@ -77,8 +405,8 @@ public:
             try {
                 fs::create_directories(dirPath);
 
-                Inode* directory = new Inode(name, true, "drwxr-xr-x", currentDirectory);
-                currentDirectory->children[name] = directory;
+                checkpoint();
+                mutableNode(cwd)->addChild(make_shared<Inode>(name, true, "drwxr-xr-x", nextIno++));
             } catch (const fs::filesystem_error& e) {
                 cout << "Error: " << e.what() << endl;
             }
@@ -88,18 +416,19 @@ public:
     }
 
     void cd(string name) {
+        Inode* currentDirectory = resolve(cwd);
         if (name == "..") {
-            if (currentDirectory != root) {
-                currentDirectory = currentDirectory->parent;
+            if (!cwd.empty()) {
+                cwd.pop_back();
             }
         } else if (currentDirectory->children.count(name)) {
-            Inode* directory = currentDirectory->children[name];
+            Inode* directory = currentDirectory->children.at(name).get();
             if (directory->isDirectory) {
                 if (directory->permissions[3] != 'x') {
                     cout << "Error: No execute permission for directory '" << name << "'." << endl;
                     return;
                 }
-                currentDirectory = directory;
+                cwd.push_back(name);
             } else {
                 cout << "Error: '" << name << "' is a file, not a directory." << endl;
             }
@@ -108,33 +437,90 @@ public:
         }
     }
 
-    void ls() {
-        for (const auto& entry : currentDirectory->children) {
-            cout << entry.first << endl;
-        }
-    }
+    // Lists the current directory by name, or by creation time or size
+    // through the directory's indexes. When the limit cuts the listing short,
+    // the last line gives the cursor for the next page.
+    void ls(ListFormat format, const ListOptions& options) {
+        Inode* directory = resolve(cwd);
+        size_t shown = 0;
+        string last;
+        bool more = false;
+        auto visit = [&](const string& name, const Inode* inode) {
+            if ((options.type == 'f' && inode->isDirectory) || (options.type == 'd' && !inode->isDirectory) ||
+                (!options.pattern.empty() && fnmatch(options.pattern.c_str(), name.c_str(), 0) != 0)) {
+                return true;
+            }
+            if (options.limit != 0 && shown == options.limit) {
+                more = true;
+                return false;
+            }
+            printEntry(format, name, inode);
+            last = name;
+            shown++;
+            return true;
+        };
+
+        // Walks an index keyed by (key, name) from just after the cursor, in
+        // O(log n) plus the entries visited
+        auto walkIndex = [&](const auto& index, auto key) {
+            auto entry = index.begin();
+            if (!options.after.empty()) {
+                auto cursor = directory->children.find(options.after);
+                if (cursor == directory->children.end()) {
+                    cout << "Error: Entry '" << options.after << "' not found." << endl;
+                    return false;
+                }
+                entry = index.upper_bound({key(cursor->second.get()), options.after});
+            }
+            for (; entry != index.end(); ++entry) {
+                const string& name = entry->first.second;
+                if (!visit(name, directory->children.at(name).get())) break;
+            }
+            return true;
+        };
 
-    void ls_l() {
-    for (const auto& entry : currentDirectory->children) {
-        std::time_t time = entry.second->creationTime;
-        struct tm * timeinfo;
-        timeinfo = localtime(&time);
-        char buffer [80];
-        strftime(buffer, 80, "%b %e %R", timeinfo);
-        cout << entry.second->permissions << "  "
-             << buffer << "  "
-             << entry.first << endl;
+        if (options.order == ListOptions::ByTime) {
+            if (!walkIndex(directory->childrenByTime, [](const Inode* inode) { return inode->creationTime; })) {
+                return;
+            }
+        } else if (options.order == ListOptions::BySize) {
+            if (!walkIndex(directory->childrenBySize, [](const Inode* inode) { return inode->size; })) {
+                return;
+            }
+        } else {
+            auto entry = options.after.empty() ? directory->children.begin()
+                                               : directory->children.upper_bound(options.after);
+            for (; entry != directory->children.end(); ++entry) {
+                if (!visit(entry->first, entry->second.get())) break;
+            }
+        }
+        if (more) {
+            cout << "-- more: --after " << last << '\n';
+        }
+        cout << flush;
     }
-}
 
-void ls_li() {
-    for (const auto& entry : currentDirectory->children) {
-        std::cout << getInode(entry.second) << "  "
-                  << entry.second->permissions << "  "
-                  << formatCreationTime(entry.second->creationTime) << "  "
-                  << entry.first << std::endl;
+    void printEntry(ListFormat format, const string& name, const Inode* inode) {
+        if (format == NamesOnly) {
+            cout << name << '\n';
+        } else if (format == LongFormat) {
+            std::time_t time = inode->creationTime;
+            struct tm * timeinfo;
+            timeinfo = localtime(&time);
+            char buffer [80];
+            strftime(buffer, 80, "%b %e %R", timeinfo);
+            cout << inode->permissions << "  "
+                 << std::setw(10) << std::setfill(' ') << inode->size << "  "
+                 << buffer << "  "
+                 << name << '\n';
+        } else {
+            cout << inode->ino << "  "
+                 << inode->permissions << "  "
+                 << std::setw(10) << std::setfill(' ') << inode->size << "  "
+                 << formatCreationTime(inode->creationTime) << "  "
+                 << name << '\n';
+        }
     }
-}
 
 std::string formatCreationTime(std::time_t time) {
     struct std::tm * timeinfo = std::localtime(&time);
@@ -167,17 +553,18 @@ std::string formatCreationTime(std::time_t time) {
 
 
     void ls_R() {
-        lsRecursive(currentDirectory, true, true, 0);
+        lsRecursive(resolve(cwd), true, true, 0);
     }
 
     void rm(string name) {
         fs::path filePath = currentPath() / name;
         if (fs::exists(filePath)) {
             if (!fs::is_directory(filePath)) {
-                fs::remove(filePath);
-                Inode* file = currentDirectory->children[name];
-                currentDirectory->children.erase(name);
-                delete file;
+                if (!discard(name, filePath)) {
+                    return;
+                }
+                checkpoint();
+                mutableNode(cwd)->removeChild(name);
             } else {
                 cout << "Error: '" << name << "' is a directory." << endl;
             }
@@ -190,10 +577,11 @@ std::string formatCreationTime(std::time_t time) {
         fs::path dirPath = currentPath() / name;
         if (fs::exists(dirPath)) {
             if (fs::is_directory(dirPath)) {
-                removeRecursive(dirPath);
-                Inode* directory = currentDirectory->children[name];
-                currentDirectory->children.erase(name);
-                delete directory;
+                if (!discard(name, dirPath)) {
+                    return;
+                }
+                checkpoint();
+                mutableNode(cwd)->removeChild(name);
             } else {
                 cout << "Error: '" << name << "' is not a directory." << endl;
             }
@@ -208,10 +596,12 @@ std::string formatCreationTime(std::time_t time) {
         if (fs::exists(oldPath)) {
             if (!fs::exists(newPath)) {
                 fs::rename(oldPath, newPath);
-                Inode* file = currentDirectory->children[oldName];
-                currentDirectory->children.erase(oldName);
-                file->name = newName;
-                currentDirectory->children[newName] = file;
+                checkpoint();
+                Inode* directory = mutableNode(cwd);
+                auto renamed = make_shared<Inode>(*directory->children.at(oldName));
+                renamed->name = newName;
+                directory->removeChild(oldName);
+                directory->addChild(renamed);
             } else {
                 cout << "Error: A file or directory named '" << newName << "' already exists." << endl;
             }
@@ -240,8 +630,11 @@ std::string formatCreationTime(std::time_t time) {
         if (fs::exists(filePath)) {
             ::chmod(filePath.c_str(), mode);
 
-            if (currentDirectory->children.find(name) != currentDirectory->children.end()) {
-                Inode* file = currentDirectory->children[name];
+            if (resolve(cwd)->children.count(name)) {
+                checkpoint();
+                vector<string> path = cwd;
+                path.push_back(name);
+                Inode* file = mutableNode(path);
                 file->permissions = toPermissionString(mode, file->isDirectory);
             }
         } else {
@@ -250,19 +643,21 @@ std::string formatCreationTime(std::time_t time) {
     }
 
     void direc() {
-        string prompt = getFullPath(currentDirectory);
+        string prompt = getFullPath(cwd);
         cout << "~" << prompt << "$ ";
     }
 
-    bool findInode(Inode* directory, const string& name, bool searchFile, bool searchDirectory, string& path) {
+    bool findInode(Inode* directory, const string& directoryPath, const string& name, bool searchFile,
+                   bool searchDirectory, string& path) {
         if ((searchFile && !directory->isDirectory && directory->name == name) ||
             (searchDirectory && directory->isDirectory && directory->name == name)) {
-            path = getFullPath(directory);
+            path = directoryPath;
             return true;
         }
 
         for (auto& child : directory->children) {
-            if (findInode(child.second, name, searchFile, searchDirectory, path)) {
+            if (findInode(child.second.get(), directoryPath + "/" + child.first, name, searchFile, searchDirectory,
+                          path)) {
                 return true;
             }
         }
@@ -274,27 +669,611 @@ std::string formatCreationTime(std::time_t time) {
         bool searchDirectory = (type == "d");
 
         string path;
-        if (findInode(root, name, searchFile, searchDirectory, path)) {
+        if (findInode(root.get(), "", name, searchFile, searchDirectory, path)) {
             cout << "Found: " << path << endl;
         } else {
             cout << "Error: " << (searchFile ? "File" : "Directory") << " '" << name << "' not found." << endl;
         }
     }
 
+    // Prints a file. The file is mapped and written to stdout in one call, so
+    // the data is never copied into a buffer of ours.
+    void cat(string name) {
+        Inode* file = findChild(name, false);
+        if (!file) {
+            return;
+        }
+        if (file->permissions[1] != 'r') {
+            cout << "Error: No read permission for file '" << name << "'." << endl;
+            return;
+        }
+        fs::path filePath = currentPath() / name;
+        int fd = open(filePath.c_str(), O_RDONLY);
+        struct stat info;
+        if (fd == -1 || fstat(fd, &info) != 0) {
+            cout << "Error: Failed to open file '" << name << "'." << endl;
+            if (fd != -1) {
+                close(fd);
+            }
+            return;
+        }
+        size_t size = info.st_size;
+        if (size > 0) {
+            void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED) {
+                cout << "Error: Failed to read file '" << name << "'." << endl;
+            } else {
+                madvise(data, size, MADV_SEQUENTIAL);
+                cout << flush;
+                writeAll(STDOUT_FILENO, static_cast<const char*>(data), size);
+                if (static_cast<const char*>(data)[size - 1] != '\n') {
+                    cout << '\n';
+                }
+                munmap(data, size);
+            }
+        }
+        close(fd);
+    }
+
+    // Replaces the contents of a file, creating it if needed
+    void write(string name, string text) {
+        Inode* currentDirectory = resolve(cwd);
+        auto existing = currentDirectory->children.find(name);
+        if (existing != currentDirectory->children.end()) {
+            if (existing->second->isDirectory) {
+                cout << "Error: '" << name << "' is a directory." << endl;
+                return;
+            }
+            if (existing->second->permissions[2] != 'w') {
+                cout << "Error: No write permission for file '" << name << "'." << endl;
+                return;
+            }
+        } else if (currentDirectory->permissions[2] != 'w') {
+            cout << "Error: No write permission in the current directory '" << currentDirectory->name << "'." << endl;
+            return;
+        }
+
+        if (!text.empty()) {
+            text += '\n';
+        }
+        // The old contents go to the store rather than being overwritten, so
+        // undo and restore can bring them back
+        fs::path filePath = currentPath() / name;
+        bool replacing = existing != currentDirectory->children.end();
+        mode_t mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+        if (replacing) {
+            mode = toMode(existing->second->permissions);
+            if (::rename(filePath.c_str(), existing->second->contents->stored.c_str()) != 0) {
+                cout << "Error: Failed to write file '" << name << "'." << endl;
+                return;
+            }
+        }
+        int fd = open(filePath.c_str(), O_CREAT | O_EXCL | O_WRONLY, mode);
+        if (fd == -1 || !writeAll(fd, text.data(), text.size())) {
+            cout << "Error: Failed to write file '" << name << "'." << endl;
+            if (fd != -1) {
+                close(fd);
+                fs::remove(filePath);
+            }
+            if (replacing) {
+                ::rename(existing->second->contents->stored.c_str(), filePath.c_str());
+            }
+            return;
+        }
+        close(fd);
+
+        checkpoint();
+        if (!replacing) {
+            auto file = make_shared<Inode>(name, false, "-rw-r--r--", nextIno++);
+            file->size = text.size();
+            file->contents = newContents();
+            mutableNode(cwd)->addChild(file);
+        } else {
+            vector<string> path = cwd;
+            path.push_back(name);
+            Inode* file = mutableNode(path);
+            uintmax_t oldSize = file->size;
+            file->size = text.size();
+            file->contents = newContents();
+            mutableNode(cwd)->childResized(name, oldSize);
+        }
+    }
+
+    // Copies a file within the current directory. The data never passes
+    // through this process: the copy shares the source's blocks (reflink)
+    // where the file system allows it, and otherwise the kernel copies them
+    // with copy_file_range, or sendfile as a last resort.
+    void cp(string source, string destination) {
+        Inode* file = findChild(source, false);
+        if (!file) {
+            return;
+        }
+        if (resolve(cwd)->children.count(destination)) {
+            cout << "Error: A file or directory named '" << destination << "' already exists." << endl;
+            return;
+        }
+        fs::path sourcePath = currentPath() / source;
+        fs::path destinationPath = currentPath() / destination;
+        int in = open(sourcePath.c_str(), O_RDONLY);
+        struct stat info;
+        if (in == -1 || fstat(in, &info) != 0) {
+            cout << "Error: Failed to open file '" << source << "'." << endl;
+            if (in != -1) {
+                close(in);
+            }
+            return;
+        }
+        int out = open(destinationPath.c_str(), O_CREAT | O_EXCL | O_WRONLY, info.st_mode & 0777);
+        if (out == -1) {
+            cout << "Error: Failed to create file '" << destination << "'." << endl;
+            close(in);
+            return;
+        }
+        bool copied = copyData(in, out, info.st_size);
+        close(in);
+        close(out);
+        if (!copied) {
+            cout << "Error: Failed to copy '" << source << "' to '" << destination << "'." << endl;
+            fs::remove(destinationPath);
+            return;
+        }
+
+        auto copy = make_shared<Inode>(destination, false, file->permissions, nextIno++);
+        copy->size = info.st_size;
+        copy->contents = newContents();
+        checkpoint();
+        mutableNode(cwd)->addChild(copy);
+    }
+
+    // Total size of the files in the current directory, or in the given
+    // file or directory, computed from the tree without touching the disk
+    void du(string name) {
+        Inode* inode = resolve(cwd);
+        if (!name.empty()) {
+            auto child = inode->children.find(name);
+            if (child == inode->children.end()) {
+                cout << "Error: File or directory '" << name << "' not found." << endl;
+                return;
+            }
+            inode = child->second.get();
+        }
+        cout << totalSize(inode) << "  " << (name.empty() ? "." : name) << endl;
+    }
+
+    // Saves the current tree under a name. Takes constant time: the snapshot
+    // shares every node with the live tree until one of them changes.
+    void snapshot(string name) {
+        if (snapshots.count(name)) {
+            cout << "Error: A snapshot named '" << name << "' already exists." << endl;
+            return;
+        }
+        snapshots[name] = Snapshot{root, std::time(nullptr)};
+        epoch++;
+    }
+
+    void listSnapshots() {
+        for (const auto& entry : snapshots) {
+            cout << formatTime(entry.second.time) << "  " << entry.first << endl;
+        }
+    }
+
+    // Differences from snapshot a to snapshot b, or to the current tree
+    void diff(string from, string to) {
+        if (!snapshots.count(from) || (!to.empty() && !snapshots.count(to))) {
+            cout << "Error: Snapshot '" << (snapshots.count(from) ? to : from) << "' not found." << endl;
+            return;
+        }
+        vector<Change> changes;
+        collectChanges(snapshots[from].root, to.empty() ? root : snapshots[to].root, "", changes);
+        for (const Change& change : changes) {
+            string suffix = (change.after ? change.after : change.before)->isDirectory ? "/" : "";
+            switch (change.kind) {
+                case Change::Removed:
+                    cout << "- " << change.path << suffix << endl;
+                    break;
+                case Change::Renamed:
+                    cout << "R " << change.path << suffix << " -> " << change.newPath << suffix << endl;
+                    break;
+                case Change::Added:
+                    cout << "+ " << change.path << suffix << endl;
+                    break;
+                case Change::Modified:
+                    cout << "M " << change.path << suffix;
+                    if (change.before->permissions != change.after->permissions) {
+                        cout << "  " << change.before->permissions << " -> " << change.after->permissions;
+                    }
+                    if (change.before->size != change.after->size) {
+                        cout << "  " << change.before->size << " -> " << change.after->size << " bytes";
+                    } else if (change.before->contents != change.after->contents) {
+                        cout << "  contents";
+                    }
+                    cout << endl;
+                    break;
+            }
+        }
+        if (changes.empty()) {
+            cout << "No differences." << endl;
+        }
+    }
+
+    void undo() {
+        if (history.empty()) {
+            cout << "Error: Nothing to undo." << endl;
+            return;
+        }
+        if (switchRoot(history.back())) {
+            history.pop_back();
+        }
+    }
+
+    // Brings the tree and the disk back to a snapshot. Can be undone.
+    void restore(string name) {
+        if (!snapshots.count(name)) {
+            cout << "Error: Snapshot '" << name << "' not found." << endl;
+            return;
+        }
+        checkpoint();
+        if (!switchRoot(snapshots[name].root)) {
+            history.pop_back();
+        }
+    }
+
 private:
-    Inode* root;
-    Inode* currentDirectory;
+    static const size_t MAX_HISTORY = 100;
+
+    InodePtr root;
+    vector<string> cwd; // Names from the root to the current directory
     fs::path rootPath;
+    fs::path storePath; // Contents of files no longer on disk
+    int nextIno = 1;
+    unsigned epoch = 1; // Nodes of an older epoch may be shared
+    map<string, Snapshot> snapshots;
+    deque<InodePtr> history; // Roots before each change, for undo
 
     fs::path currentPath() {
-        return rootPath / fs::relative(getFullPath(currentDirectory), "/");
+        return diskPath(getFullPath(cwd));
     }
 
-    string getFullPath(Inode* inode) {
-        if (inode->parent == nullptr) {
-            return "";
+    fs::path diskPath(const string& path) {
+        return rootPath / fs::path(path).relative_path();
+    }
+
+    string getFullPath(const vector<string>& path) {
+        string fullPath;
+        for (const string& name : path) {
+            fullPath += "/" + name;
+        }
+        return fullPath;
+    }
+
+    Inode* resolve(const vector<string>& path) {
+        Inode* node = root.get();
+        for (const string& name : path) {
+            node = node->children.at(name).get();
+        }
+        return node;
+    }
+
+    // Returns the node at path ready to be changed. Nodes from before the
+    // last checkpoint or snapshot may be shared with it, so they are copied
+    // first, from the root down, and the older versions never see the change.
+    // A node's use count can't tell: the children maps share their own nodes.
+    Inode* mutableNode(const vector<string>& path) {
+        detach(root);
+        Inode* node = root.get();
+        for (const string& name : path) {
+            InodePtr child = node->children.at(name);
+            if (detach(child)) {
+                node->children.insert_or_assign(name, child);
+            }
+            node = child.get();
+        }
+        return node;
+    }
+
+    bool detach(InodePtr& node) {
+        if (node->epoch == epoch) {
+            return false;
+        }
+        node = make_shared<Inode>(*node);
+        node->epoch = epoch;
+        return true;
+    }
+
+    shared_ptr<const Contents> newContents() {
+        return make_shared<Contents>(Contents{(storePath / to_string(nextIno++)).string()});
+    }
+
+    // Moves the files of an entry that is leaving the disk into the store,
+    // where a snapshot or undo can take them back from. Files are renamed,
+    // never copied.
+    void storeContents(const Inode* inode, const fs::path& path) {
+        if (inode->isDirectory) {
+            for (const auto& child : inode->children) {
+                storeContents(child.second.get(), path / child.first);
+            }
+        } else {
+            fs::rename(path, inode->contents->stored);
+        }
+    }
+
+    // Takes an entry of the current directory off the disk, keeping its
+    // contents in the store. False, after printing the error, on failure.
+    bool discard(const string& name, const fs::path& path) {
+        Inode* currentDirectory = resolve(cwd);
+        auto child = currentDirectory->children.find(name);
+        try {
+            if (child != currentDirectory->children.end()) {
+                storeContents(child->second.get(), path);
+            }
+            removeRecursive(path);
+        } catch (const fs::filesystem_error& e) {
+            cout << "Error: " << e.what() << endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Remembers the current tree before a change so undo can return to it
+    void checkpoint() {
+        history.push_back(root);
+        epoch++;
+        if (history.size() > MAX_HISTORY) {
+            history.pop_front();
+        }
+    }
+
+    // Lists what turns the tree `from` into `to`. Subtrees both versions
+    // still share are skipped without being visited, so the cost depends on
+    // the paths that changed, not on the size of the tree. Entries are
+    // matched by inode number: a name whose inode changed is a removal and an
+    // addition, and a removed and an added entry with the same inode number
+    // in one directory are a rename.
+    void collectChanges(const InodePtr& from, const InodePtr& to, const string& path, vector<Change>& changes) {
+        if (from == to) {
+            return;
+        }
+        map<int, InodePtr> removed;
+        vector<InodePtr> added;
+        for (const auto& entry : from->children) {
+            auto other = to->children.find(entry.first);
+            if (other == to->children.end() || other->second->ino != entry.second->ino) {
+                removed[entry.second->ino] = entry.second;
+            }
+        }
+        for (const auto& entry : to->children) {
+            auto other = from->children.find(entry.first);
+            if (other == from->children.end() || other->second->ino != entry.second->ino) {
+                added.push_back(entry.second);
+            }
+        }
+
+        vector<pair<InodePtr, InodePtr>> renamed;
+        vector<InodePtr> created;
+        for (const InodePtr& node : added) {
+            auto old = removed.find(node->ino);
+            if (old != removed.end()) {
+                renamed.push_back({old->second, node});
+                removed.erase(old);
+            } else {
+                created.push_back(node);
+            }
+        }
+
+        for (const auto& entry : from->children) {
+            auto old = removed.find(entry.second->ino);
+            if (old != removed.end() && old->second == entry.second) {
+                changes.push_back({Change::Removed, path + "/" + entry.first, "", entry.second, nullptr});
+            }
+        }
+        for (const auto& pair : renamed) {
+            string newPath = path + "/" + pair.second->name;
+            changes.push_back({Change::Renamed, path + "/" + pair.first->name, newPath, pair.first, pair.second});
+            collectEntryChanges(pair.first, pair.second, newPath, changes);
+        }
+        for (const InodePtr& node : created) {
+            changes.push_back({Change::Added, path + "/" + node->name, "", nullptr, node});
+        }
+        for (const auto& entry : from->children) {
+            auto other = to->children.find(entry.first);
+            if (other != to->children.end() && other->second->ino == entry.second->ino) {
+                collectEntryChanges(entry.second, other->second, path + "/" + entry.first, changes);
+            }
+        }
+    }
+
+    // Changes inside and to one entry present in both versions
+    void collectEntryChanges(const InodePtr& from, const InodePtr& to, const string& path, vector<Change>& changes) {
+        if (from == to) {
+            return;
+        }
+        if (from->isDirectory) {
+            collectChanges(from, to, path, changes);
+        }
+        if (from->permissions != to->permissions || from->contents != to->contents) {
+            changes.push_back({Change::Modified, path, "", from, to});
+        }
+    }
+
+    // Replaces the tree with another version and updates the disk to match.
+    // Removed files go to the store and added ones come back from it, so
+    // switching back later loses nothing. Refuses, returning false, if a
+    // file of the target version has contents that were not kept.
+    bool switchRoot(const InodePtr& target) {
+        vector<Change> changes;
+        collectChanges(root, target, "", changes);
+        set<const Contents*> available;
+        for (const Change& change : changes) {
+            if (change.kind == Change::Removed || (change.kind == Change::Modified && !change.before->isDirectory)) {
+                listContents(change.before.get(), available);
+            }
+        }
+        for (const Change& change : changes) {
+            if ((change.kind == Change::Added || (change.kind == Change::Modified && !change.after->isDirectory)) &&
+                !contentsAvailable(change.after.get(), available)) {
+                cout << "Error: The contents of '" << change.path << "' were not kept, nothing was changed." << endl;
+                return false;
+            }
+        }
+
+        // A rename may target the name another renamed entry still has;
+        // that entry is parked in the store until its own rename comes
+        map<string, fs::path> parked;
+        try {
+            for (const Change& change : changes) {
+                switch (change.kind) {
+                    case Change::Removed:
+                        storeContents(change.before.get(), diskPath(change.path));
+                        removeRecursive(diskPath(change.path));
+                        break;
+                    case Change::Renamed: {
+                        auto source = parked.find(change.path);
+                        fs::path from = source != parked.end() ? source->second : diskPath(change.path);
+                        if (fs::exists(diskPath(change.newPath))) {
+                            fs::path spot = storePath / ("parked" + to_string(parked.size()));
+                            fs::rename(diskPath(change.newPath), spot);
+                            parked[change.newPath] = spot;
+                        }
+                        fs::rename(from, diskPath(change.newPath));
+                        break;
+                    }
+                    case Change::Added:
+                        createOnDisk(change.after.get(), diskPath(change.path));
+                        break;
+                    case Change::Modified:
+                        if (change.before->contents != change.after->contents) {
+                            storeContents(change.before.get(), diskPath(change.path));
+                            createOnDisk(change.after.get(), diskPath(change.path));
+                        }
+                        ::chmod(diskPath(change.path).c_str(), toMode(change.after->permissions));
+                        break;
+                }
+            }
+        } catch (const fs::filesystem_error& e) {
+            cout << "Error: " << e.what() << endl;
+        }
+        root = target;
+
+        // The current directory may not exist in this version
+        Inode* node = root.get();
+        for (size_t i = 0; i < cwd.size(); ++i) {
+            auto child = node->children.find(cwd[i]);
+            if (child == node->children.end() || !child->second->isDirectory) {
+                cwd.resize(i);
+                break;
+            }
+            node = child->second.get();
+        }
+        return true;
+    }
+
+    void listContents(const Inode* inode, set<const Contents*>& contents) {
+        if (!inode->isDirectory) {
+            contents.insert(inode->contents.get());
+        }
+        for (const auto& child : inode->children) {
+            listContents(child.second.get(), contents);
+        }
+    }
+
+    // True if every file under inode is empty, in the store, or in `pending`
+    bool contentsAvailable(const Inode* inode, const set<const Contents*>& pending) {
+        if (!inode->isDirectory) {
+            return inode->size == 0 || pending.count(inode->contents.get()) || fs::exists(inode->contents->stored);
+        }
+        for (const auto& child : inode->children) {
+            if (!contentsAvailable(child.second.get(), pending)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Recreates an entry that only exists in the tree, moving its files' data
+    // back from the store. Empty files that were never stored are created.
+    void createOnDisk(Inode* inode, const fs::path& path) {
+        if (inode->isDirectory) {
+            fs::create_directory(path);
+            for (const auto& child : inode->children) {
+                createOnDisk(child.second.get(), path / child.first);
+            }
+        } else if (fs::exists(inode->contents->stored)) {
+            fs::rename(inode->contents->stored, path);
+        } else {
+            int fd = open(path.c_str(), O_CREAT | O_WRONLY, S_IRUSR | S_IWUSR);
+            if (fd != -1) {
+                close(fd);
+            }
         }
-        return getFullPath(inode->parent) + "/" + inode->name;
+        ::chmod(path.c_str(), toMode(inode->permissions));
+    }
+
+    // Looks up an entry of the current directory, printing an error if it's
+    // missing or not of the expected kind
+    Inode* findChild(const string& name, bool directory) {
+        Inode* currentDirectory = resolve(cwd);
+        auto child = currentDirectory->children.find(name);
+        if (child == currentDirectory->children.end()) {
+            cout << "Error: " << (directory ? "Directory" : "File") << " '" << name << "' not found." << endl;
+            return nullptr;
+        }
+        if (child->second->isDirectory != directory) {
+            cout << "Error: '" << name << "' is " << (directory ? "not a directory." : "a directory.") << endl;
+            return nullptr;
+        }
+        return child->second.get();
+    }
+
+    uintmax_t totalSize(const Inode* inode) {
+        uintmax_t total = inode->size;
+        for (const auto& child : inode->children) {
+            total += totalSize(child.second.get());
+        }
+        return total;
+    }
+
+    bool writeAll(int fd, const char* data, size_t size) {
+        while (size > 0) {
+            ssize_t written = ::write(fd, data, size);
+            if (written <= 0) {
+                return false;
+            }
+            data += written;
+            size -= written;
+        }
+        return true;
+    }
+
+    bool copyData(int in, int out, off_t size) {
+        if (ioctl(out, FICLONE, in) == 0) {
+            return true;
+        }
+        // Both calls advance the file offsets, so sendfile picks up
+        // wherever copy_file_range stopped
+        off_t copied = 0;
+        while (copied < size) {
+            ssize_t chunk = copy_file_range(in, nullptr, out, nullptr, size - copied, 0);
+            if (chunk <= 0) {
+                break;
+            }
+            copied += chunk;
+        }
+        while (copied < size) {
+            ssize_t chunk = sendfile(out, in, nullptr, size - copied);
+            if (chunk <= 0) {
+                return false;
+            }
+            copied += chunk;
+        }
+        return true;
+    }
+
+    mode_t toMode(const string& permissions) {
+        mode_t mode = 0;
+        for (size_t i = 1; i < permissions.size(); ++i) {
+            mode = (mode << 1) | (permissions[i] != '-');
+        }
+        return mode;
     }
 
     void lsRecursive(Inode* directory, bool includeFiles, bool includeDirectories, int level) {
@@ -307,7 +1286,7 @@ private:
 
         for (const auto& child : directory->children) {
             if (child.second->isDirectory) {
-                lsRecursive(child.second, includeFiles, includeDirectories, level + 1);
+                lsRecursive(child.second.get(), includeFiles, includeDirectories, level + 1);
             } else if (includeFiles) {
                 for (int i = 0; i < level + 1; ++i) {
                     cout << "  ";
@@ -317,13 +1296,6 @@ private:
         }
     }
 
-    void deleteInode(Inode* inode) {
-        for (auto& child : inode->children) {
-            deleteInode(child.second);
-        }
-        delete inode;
-    }
-
     string toPermissionString(mode_t mode, bool isDirectory) {
         string permissions = isDirectory ? "d" : "-";
         for (int i = 2; i >= 0; --i) {
@@ -335,17 +1307,6 @@ private:
         return permissions;
     }
 
-    int getInode(Inode* inode) {
-    static int inodeCounter = 1;
-    static std::map<Inode*, int> inodeMap;
-
-    if (inodeMap.find(inode) == inodeMap.end()) {
-        inodeMap[inode] = inodeCounter++;
-    }
-
-    return inodeMap[inode];
-}
-
     void removeRecursive(const fs::path& path) {
         if (fs::exists(path)) {
             fs::remove_all(path);
@@ -353,6 +1314,7 @@ private:
     }
 
     void mapFileSystem(const fs::path& path, Inode* parentNode) {
+    vector<InodePtr> children;
     for (const auto& entry : fs::directory_iterator(path)) {
         string name = entry.path().filename().string();
         bool isDir = entry.is_directory();
@@ -360,14 +1322,19 @@ private:
         std::filesystem::file_time_type fileTime = fs::last_write_time(entry.path());
         auto timePoint = std::chrono::time_point_cast<std::chrono::system_clock::duration>(fileTime - std::filesystem::file_time_type::clock::now() + std::chrono::system_clock::now());
         std::time_t creationTime = std::chrono::system_clock::to_time_t(timePoint);
-        Inode* node = new Inode(name, isDir, permissions, parentNode);
+        auto node = make_shared<Inode>(name, isDir, permissions, nextIno++);
         node->creationTime = creationTime; // Set creation time
-        parentNode->children[name] = node;
+        if (!isDir) {
+            node->size = entry.file_size();
+            node->contents = newContents();
+        }
+        children.push_back(node);
 
         if (isDir) {
-            mapFileSystem(entry.path(), node); // Recursively map directories
+            mapFileSystem(entry.path(), node.get()); // Recursively map directories
         }
     }
+    parentNode->setChildren(move(children));
 }
 
 
@@ -403,6 +1370,32 @@ private:
     }
 };
 
+// Reads the options of ls, ls-l and ls-li; false if they are malformed
+bool parseListOptions(const vector<string>& tokens, ListOptions& options) {
+    for (size_t i = 1; i < tokens.size(); ++i) {
+        const string& option = tokens[i];
+        if (i + 1 == tokens.size()) {
+            return false; // Every option takes a value
+        }
+        const string& value = tokens[++i];
+        if (option == "--limit" && !value.empty() && value.size() < 10 && all_of(value.begin(), value.end(), ::isdigit)) {
+            options.limit = stoul(value);
+        } else if (option == "--after") {
+            options.after = value;
+        } else if (option == "--type" && (value == "f" || value == "d")) {
+            options.type = value[0];
+        } else if (option == "--name") {
+            options.pattern = value;
+        } else if (option == "--sort" && (value == "name" || value == "time" || value == "size")) {
+            options.order = value == "time" ? ListOptions::ByTime
+                          : value == "size" ? ListOptions::BySize : ListOptions::ByName;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
 int main() {
     FileSystem fs;
     
@@ -422,12 +1415,13 @@ int main() {
             fs.touch(tokens[1]);
         } else if (cmd == "cd" && tokens.size() == 2) {
             fs.cd(tokens[1]);
-        } else if (cmd == "ls") {
-            fs.ls();
-        } else if (cmd == "ls-l") {
-            fs.ls_l();
-        } else if (cmd == "ls-li") {
-            fs.ls_li();
+        } else if (cmd == "ls" || cmd == "ls-l" || cmd == "ls-li") {
+            ListOptions options;
+            if (parseListOptions(tokens, options)) {
+                fs.ls(cmd == "ls" ? NamesOnly : cmd == "ls-l" ? LongFormat : LongFormatWithInode, options);
+            } else {
+                cout << "Error: Unknown command or incorrect usage." << endl;
+            }
         } else if (cmd == "ls-R") {
             fs.ls_R();
         } else if (cmd == "rm" && tokens.size() == 2) {
@@ -440,6 +1434,28 @@ int main() {
             fs.chmod(tokens[1], tokens[2]);
         } else if (cmd == "find" && tokens.size() == 3) {
             fs.find(tokens[1], tokens[2]);
+        } else if (cmd == "cat" && tokens.size() == 2) {
+            fs.cat(tokens[1]);
+        } else if (cmd == "write" && tokens.size() >= 2) {
+            string text;
+            for (size_t i = 2; i < tokens.size(); ++i) {
+                text += (i > 2 ? " " : "") + tokens[i];
+            }
+            fs.write(tokens[1], text);
+        } else if (cmd == "cp" && tokens.size() == 3) {
+            fs.cp(tokens[1], tokens[2]);
+        } else if (cmd == "du" && tokens.size() <= 2) {
+            fs.du(tokens.size() == 2 ? tokens[1] : "");
+        } else if (cmd == "snapshot" && tokens.size() == 2) {
+            fs.snapshot(tokens[1]);
+        } else if (cmd == "snapshots" && tokens.size() == 1) {
+            fs.listSnapshots();
+        } else if (cmd == "diff" && (tokens.size() == 2 || tokens.size() == 3)) {
+            fs.diff(tokens[1], tokens.size() == 3 ? tokens[2] : "");
+        } else if (cmd == "undo" && tokens.size() == 1) {
+            fs.undo();
+        } else if (cmd == "restore" && tokens.size() == 2) {
+            fs.restore(tokens[1]);
         } else if (cmd == "exit") {
             break;
         } else {